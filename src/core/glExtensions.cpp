@@ -0,0 +1,39 @@
+#include "glExtensions.h"
+#include <iostream>
+
+// raylib links GLFW in and exports it, so there's no need for a loader library
+extern "C" void *glfwGetProcAddress(const char *name);
+
+template <typename Fn> static void LoadProc(Fn &fn, const char *name) {
+  fn = reinterpret_cast<Fn>(glfwGetProcAddress(name));
+}
+
+void LoadGlExtensions() {
+  LoadProc(gl.fenceSync, "glFenceSync");
+  LoadProc(gl.clientWaitSync, "glClientWaitSync");
+  LoadProc(gl.deleteSync, "glDeleteSync");
+  LoadProc(gl.genQueries, "glGenQueries");
+  LoadProc(gl.deleteQueries, "glDeleteQueries");
+  LoadProc(gl.beginQuery, "glBeginQuery");
+  LoadProc(gl.endQuery, "glEndQuery");
+  LoadProc(gl.getQueryObjectiv, "glGetQueryObjectiv");
+  LoadProc(gl.getQueryObjectui64v, "glGetQueryObjectui64v");
+  LoadProc(gl.bindBuffer, "glBindBuffer");
+  LoadProc(gl.copyBufferSubData, "glCopyBufferSubData");
+  LoadProc(gl.drawElementsBaseVertex, "glDrawElementsBaseVertex");
+  LoadProc(gl.multiDrawElementsBaseVertex, "glMultiDrawElementsBaseVertex");
+
+  if (!gl.hasSync()) {
+    std::cout << "GL sync objects unavailable, falling back to frame delays"
+              << std::endl;
+  }
+  if (gl.bindBuffer == nullptr || gl.copyBufferSubData == nullptr ||
+      gl.drawElementsBaseVertex == nullptr) {
+    std::cout << "ERROR: GL 3.2 buffer entry points missing, terrain won't draw"
+              << std::endl;
+  }
+  if (!gl.hasTimerQuery()) {
+    std::cout << "GL timer queries unavailable, GPU times will read 0"
+              << std::endl;
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+// GL entry points raylib's rlgl doesn't wrap, resolved through GLFW once a
+// context exists. Every pointer may be null (old driver, ES context), so
+// callers check before use.
+
+using GLsync = struct __GLsync *;
+
+inline constexpr unsigned int GL_SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+inline constexpr unsigned int GL_ALREADY_SIGNALED = 0x911A;
+inline constexpr unsigned int GL_CONDITION_SATISFIED = 0x911C;
+inline constexpr unsigned int GL_TIME_ELAPSED = 0x88BF;
+inline constexpr unsigned int GL_QUERY_RESULT = 0x8866;
+inline constexpr unsigned int GL_QUERY_RESULT_AVAILABLE = 0x8867;
+inline constexpr unsigned int GL_COPY_READ_BUFFER = 0x8F36;
+inline constexpr unsigned int GL_COPY_WRITE_BUFFER = 0x8F37;
+
+struct GlExtensions {
+  GLsync (*fenceSync)(unsigned int condition, unsigned int flags) = nullptr;
+  unsigned int (*clientWaitSync)(GLsync sync, unsigned int flags,
+                                 std::uint64_t timeout) = nullptr;
+  void (*deleteSync)(GLsync sync) = nullptr;
+
+  void (*genQueries)(int count, unsigned int *ids) = nullptr;
+  void (*deleteQueries)(int count, const unsigned int *ids) = nullptr;
+  void (*beginQuery)(unsigned int target, unsigned int id) = nullptr;
+  void (*endQuery)(unsigned int target) = nullptr;
+  void (*getQueryObjectiv)(unsigned int id, unsigned int name, int *value) = nullptr;
+  void (*getQueryObjectui64v)(unsigned int id, unsigned int name,
+                              std::uint64_t *value) = nullptr;
+
+  // GL 3.1/3.2 core, so present on raylib's default 3.3 context
+  void (*bindBuffer)(unsigned int target, unsigned int buffer) = nullptr;
+  void (*copyBufferSubData)(unsigned int readTarget, unsigned int writeTarget,
+                            std::intptr_t readOffset, std::intptr_t writeOffset,
+                            std::intptr_t size) = nullptr;
+  void (*drawElementsBaseVertex)(unsigned int mode, int count, unsigned int type,
+                                 const void *indices, int baseVertex) = nullptr;
+  void (*multiDrawElementsBaseVertex)(unsigned int mode, const int *counts,
+                                      unsigned int type, const void *const *indices,
+                                      int drawCount, const int *baseVertices) = nullptr;
+
+  [[nodiscard]] bool hasSync() const noexcept {
+    return fenceSync != nullptr && clientWaitSync != nullptr &&
+           deleteSync != nullptr;
+  }
+
+  [[nodiscard]] bool hasTimerQuery() const noexcept {
+    return genQueries != nullptr && deleteQueries != nullptr &&
+           beginQuery != nullptr && endQuery != nullptr &&
+           getQueryObjectiv != nullptr && getQueryObjectui64v != nullptr;
+  }
+};
+
+inline GlExtensions gl;
+
+// Call after InitWindow()
+void LoadGlExtensions();
@@ -0,0 +1,50 @@
+#include "gpuTimer.h"
+#include "glExtensions.h"
+#include "rlgl.h"
+
+void GpuTimer::begin() {
+  if (!gl.hasTimerQuery()) {
+    return;
+  }
+  if (queries[0] == 0) {
+    gl.genQueries(latency, queries.data());
+  }
+
+  // Collect this slot's result from `latency` frames ago. If the GPU still
+  // hasn't finished it, skip timing this frame rather than wait.
+  const int slot = frame % latency;
+  if (pending[slot]) {
+    int available = 0;
+    gl.getQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == 0) {
+      return;
+    }
+    std::uint64_t nanoseconds = 0;
+    gl.getQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+    lastMilliseconds = static_cast<float>(static_cast<double>(nanoseconds) / 1e6);
+    pending[slot] = false;
+  }
+
+  // raylib batches immediate-mode draws; keep earlier ones out of the query
+  rlDrawRenderBatchActive();
+  gl.beginQuery(GL_TIME_ELAPSED, queries[slot]);
+  timing = true;
+}
+
+void GpuTimer::end() {
+  if (timing) {
+    rlDrawRenderBatchActive();
+    gl.endQuery(GL_TIME_ELAPSED);
+    pending[frame % latency] = true;
+    timing = false;
+  }
+  ++frame;
+}
+
+void GpuTimer::release() {
+  if (queries[0] != 0) {
+    gl.deleteQueries(latency, queries.data());
+  }
+  queries = {};
+  pending = {};
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <array>
+
+// GPU time of the draw calls between begin() and end(), from GL_TIME_ELAPSED
+// queries. Each frame's result is read back several frames later, so reading
+// never waits on the GPU. Reads 0 without timer query support.
+class GpuTimer {
+public:
+  void begin();
+  void end();
+  void release(); // Before the GL context goes away
+
+  [[nodiscard]] float milliseconds() const noexcept { return lastMilliseconds; }
+
+private:
+  static constexpr int latency = 4; // Frames between issuing and reading
+
+  std::array<unsigned int, latency> queries{};
+  std::array<bool, latency> pending{};
+  int frame = 0;
+  bool timing = false;
+  float lastMilliseconds = 0.0f;
+};
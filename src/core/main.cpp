@@ -1,21 +1,35 @@
 #include "../game/game.h"
+#include "glExtensions.h"
+#include "profiler.h"
 #include "raylib.h"
+#include <string_view>
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--bake-world") {
+      return BakeWorld(worldBakeDirectory) ? 0 : 1;
+    }
+  }
 
-int main() {
   SetConfigFlags(FLAG_MSAA_4X_HINT);
   InitWindow(1080, 720, "The Raven");
   SetWindowState(FLAG_WINDOW_RESIZABLE);
+  LoadGlExtensions();
   // SetTargetFPS(60);
   SetTraceLogLevel(LOG_WARNING);
 
   InitGame();
 
   while (!WindowShouldClose()) {
+    BeginProfilerFrame();
     UpdateGame();
     BeginDrawing();
     ClearBackground(Color{15, 15, 20, 255});
     DrawGame();
-    EndDrawing();
+    {
+      const ProfileScope scope("EndDrawing (swap, events)");
+      EndDrawing();
+    }
   }
 
   UnloadGame();
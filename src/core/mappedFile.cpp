@@ -0,0 +1,76 @@
+#include "mappedFile.h"
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RAVEN_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+#ifdef RAVEN_HAS_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat info{};
+  if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                        PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view != MAP_FAILED) {
+      data = static_cast<const std::byte *>(view);
+      size = static_cast<std::size_t>(info.st_size);
+      mapped = true;
+    }
+  }
+  // The mapping stays valid after the descriptor is closed
+  ::close(fd);
+  if (mapped) {
+    return;
+  }
+#endif
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return;
+  }
+  buffer.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char *>(buffer.data()),
+                 static_cast<std::streamsize>(buffer.size()))) {
+    buffer.clear();
+  }
+  data = buffer.data();
+  size = buffer.size();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    buffer = std::move(other.buffer);
+    mapped = std::exchange(other.mapped, false);
+    size = std::exchange(other.size, 0);
+    data = mapped ? std::exchange(other.data, nullptr) : buffer.data();
+    other.data = nullptr;
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { close(); }
+
+void MappedFile::close() noexcept {
+#ifdef RAVEN_HAS_MMAP
+  if (mapped) {
+    ::munmap(const_cast<std::byte *>(data), size);
+  }
+#endif
+  data = nullptr;
+  size = 0;
+  mapped = false;
+  buffer.clear();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Read-only view of a whole file. Memory-mapped where the platform allows it,
+// otherwise read into memory once. Empty if the file can't be opened.
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::filesystem::path &path);
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return {data, size};
+  }
+  [[nodiscard]] bool empty() const noexcept { return size == 0; }
+
+private:
+  void close() noexcept;
+
+  const std::byte *data = nullptr;
+  std::size_t size = 0;
+  bool mapped = false;
+  std::vector<std::byte> buffer; // Fallback storage when not mapped
+};
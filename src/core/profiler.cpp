@@ -0,0 +1,253 @@
+#include "profiler.h"
+#include "raylib.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frames are a ring of profilerFrames records. Scopes append to the current
+// one under a mutex: the main thread has a few dozen a frame and the chunk
+// workers a handful per chunk, so contention is negligible next to the
+// spans themselves.
+
+struct ProfileEvent {
+  const char *name;
+  int thread;
+  std::int64_t start; // Microseconds since the profiler started
+  std::int64_t duration;
+};
+
+struct ProfileCounter {
+  const char *name;
+  float value;
+};
+
+struct ProfileFrame {
+  std::int64_t start = 0;
+  std::int64_t duration = 0;
+  std::vector<ProfileEvent> events;
+  std::vector<ProfileCounter> counters;
+};
+
+constexpr int profilerFrames = 300;
+constexpr float graphScaleMs = 50.0f; // Frame time at the top of the graph
+
+using Clock = std::chrono::steady_clock;
+static const Clock::time_point epoch = Clock::now();
+
+static std::mutex profilerMutex;
+static std::array<ProfileFrame, profilerFrames> frames;
+static int currentFrame = 0;
+static int completedFrames = 0; // Kept, up to profilerFrames - 1
+static bool recording = false;
+static int mainThread = 0;
+static std::atomic<int> nextThread{0};
+
+[[nodiscard]] static std::int64_t nowMicroseconds() noexcept {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - epoch).count();
+}
+
+[[nodiscard]] static int threadIndex() noexcept {
+  thread_local const int index = nextThread++;
+  return index;
+}
+
+// Completed frames, oldest first
+template <typename Fn> static void forEachCompletedFrame(Fn &&fn) {
+  for (int i = completedFrames; i > 0; --i) {
+    fn(frames[static_cast<std::size_t>((currentFrame - i + profilerFrames) % profilerFrames)]);
+  }
+}
+
+ProfileScope::ProfileScope(const char *scopeName) noexcept
+    : name(scopeName), start(nowMicroseconds()) {}
+
+ProfileScope::~ProfileScope() {
+  const std::int64_t end = nowMicroseconds();
+  const int thread = threadIndex();
+  const std::lock_guard lock(profilerMutex);
+  if (recording) {
+    frames[static_cast<std::size_t>(currentFrame)].events.push_back(
+        {name, thread, start, end - start});
+  }
+}
+
+void BeginProfilerFrame() {
+  const std::int64_t now = nowMicroseconds();
+  const std::lock_guard lock(profilerMutex);
+  mainThread = threadIndex();
+  if (recording) {
+    ProfileFrame &last = frames[static_cast<std::size_t>(currentFrame)];
+    last.duration = now - last.start;
+    currentFrame = (currentFrame + 1) % profilerFrames;
+    completedFrames = std::min(completedFrames + 1, profilerFrames - 1);
+  }
+  ProfileFrame &frame = frames[static_cast<std::size_t>(currentFrame)];
+  frame.start = now;
+  frame.duration = 0;
+  frame.events.clear();
+  frame.counters.clear();
+  recording = true;
+}
+
+void RecordProfilerCounter(const char *name, float value) {
+  const std::lock_guard lock(profilerMutex);
+  if (recording) {
+    frames[static_cast<std::size_t>(currentFrame)].counters.push_back({name, value});
+  }
+}
+
+void DrawProfilerOverlay(int x, int y) {
+  struct ScopeTotal {
+    const char *name;
+    bool worker;
+    double total; // Milliseconds over all kept frames
+    double peak;  // Largest single frame's total
+    double frame; // Running total for the frame being summed
+  };
+  struct CounterTotal {
+    const char *name;
+    double total;
+    int samples;
+  };
+
+  std::vector<float> frameMs;
+  std::vector<ScopeTotal> scopes;
+  std::vector<CounterTotal> counters;
+  {
+    const std::lock_guard lock(profilerMutex);
+    forEachCompletedFrame([&](const ProfileFrame &frame) {
+      frameMs.push_back(static_cast<float>(frame.duration) / 1000.0f);
+      for (const ProfileEvent &event : frame.events) {
+        const bool worker = event.thread != mainThread;
+        auto scope = std::find_if(scopes.begin(), scopes.end(), [&](const ScopeTotal &s) {
+          return s.name == event.name && s.worker == worker;
+        });
+        if (scope == scopes.end()) {
+          scopes.push_back({event.name, worker, 0.0, 0.0, 0.0});
+          scope = scopes.end() - 1;
+        }
+        scope->frame += static_cast<double>(event.duration) / 1000.0;
+      }
+      for (ScopeTotal &scope : scopes) {
+        scope.total += scope.frame;
+        scope.peak = std::max(scope.peak, scope.frame);
+        scope.frame = 0.0;
+      }
+      for (const ProfileCounter &counter : frame.counters) {
+        auto total = std::find_if(counters.begin(), counters.end(),
+                                  [&](const CounterTotal &c) { return c.name == counter.name; });
+        if (total == counters.end()) {
+          counters.push_back({counter.name, 0.0, 0});
+          total = counters.end() - 1;
+        }
+        total->total += counter.value;
+        ++total->samples;
+      }
+    });
+  }
+  if (frameMs.empty()) {
+    return;
+  }
+
+  constexpr int width = 2 * profilerFrames;
+  constexpr int graphHeight = 100;
+  constexpr int lineHeight = 18;
+  const int lines = 2 + static_cast<int>(scopes.size() + counters.size());
+  DrawRectangle(x - 5, y - 5, width + 10, graphHeight + lines * lineHeight + 15,
+                Fade(BLACK, 0.7f));
+
+  // Frame times, newest on the right, against 60 and 30 FPS lines
+  const auto graphY = [y](float ms) {
+    return y + graphHeight - static_cast<int>(std::min(ms / graphScaleMs, 1.0f) * graphHeight);
+  };
+  const int graphLeft = x + width - 2 * static_cast<int>(frameMs.size());
+  for (std::size_t i = 0; i < frameMs.size(); ++i) {
+    const float ms = frameMs[i];
+    const Color color = ms > 33.4f ? RED : ms > 16.7f ? ORANGE : GREEN;
+    const int top = graphY(ms);
+    DrawRectangle(graphLeft + 2 * static_cast<int>(i), top, 2, y + graphHeight - top, color);
+  }
+  for (const float ms : {1000.0f / 60.0f, 1000.0f / 30.0f}) {
+    DrawLine(x, graphY(ms), x + width, graphY(ms), Fade(WHITE, 0.5f));
+  }
+
+  std::vector<float> sorted = frameMs;
+  std::sort(sorted.begin(), sorted.end());
+  const auto percentile = [&sorted](float p) {
+    return sorted[static_cast<std::size_t>(p * static_cast<float>(sorted.size() - 1))];
+  };
+  int line = y + graphHeight + 10;
+  const std::string frameText =
+      std::format("Frame ms over {} frames: p50 {:.2f}, p95 {:.2f}, p99 {:.2f}, max {:.2f}",
+                  sorted.size(), percentile(0.5f), percentile(0.95f), percentile(0.99f),
+                  sorted.back());
+  DrawText(frameText.c_str(), x, line, 16, WHITE);
+  line += lineHeight;
+  DrawText("Scope                        avg ms/frame   worst frame", x, line, 16, LIGHTGRAY);
+  line += lineHeight;
+
+  const auto frameCount = static_cast<double>(frameMs.size());
+  for (const ScopeTotal &scope : scopes) {
+    const std::string name =
+        scope.worker ? std::format("{} (workers)", scope.name) : std::string(scope.name);
+    const std::string text =
+        std::format("{:<28} {:>8.3f}   {:>8.3f}", name, scope.total / frameCount, scope.peak);
+    DrawText(text.c_str(), x, line, 16, scope.worker ? SKYBLUE : WHITE);
+    line += lineHeight;
+  }
+  for (const CounterTotal &counter : counters) {
+    const std::string text =
+        std::format("{:<28} {:>8.3f}", counter.name, counter.total / counter.samples);
+    DrawText(text.c_str(), x, line, 16, YELLOW);
+    line += lineHeight;
+  }
+}
+
+bool ExportProfilerTrace(const std::filesystem::path &path) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file) {
+    std::cout << "ERROR: Could not write profiler trace to " << path << std::endl;
+    return false;
+  }
+
+  const std::lock_guard lock(profilerMutex);
+  std::string json = "{\"traceEvents\":[\n";
+  const auto append = [&json](const std::string &event) {
+    json += event;
+    json += ",\n";
+  };
+  for (int thread = 0; thread < nextThread; ++thread) {
+    const std::string name =
+        thread == mainThread ? std::string("main") : std::format("worker {}", thread);
+    append(std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                       thread, name));
+  }
+  forEachCompletedFrame([&](const ProfileFrame &frame) {
+    append(std::format(R"({{"name":"frame","cat":"frame","ph":"X","ts":{},"dur":{},"pid":1,"tid":{}}})",
+                       frame.start, frame.duration, mainThread));
+    for (const ProfileEvent &event : frame.events) {
+      append(std::format(R"({{"name":"{}","cat":"cpu","ph":"X","ts":{},"dur":{},"pid":1,"tid":{}}})",
+                         event.name, event.start, event.duration, event.thread));
+    }
+    for (const ProfileCounter &counter : frame.counters) {
+      append(std::format(R"({{"name":"{}","ph":"C","ts":{},"pid":1,"args":{{"value":{}}}}})",
+                         counter.name, frame.start, counter.value));
+    }
+  });
+  if (json.ends_with(",\n")) {
+    json.resize(json.size() - 2);
+  }
+  json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+  file << json;
+
+  std::cout << "Profiler trace (" << completedFrames << " frames) written to " << path
+            << std::endl;
+  return static_cast<bool>(file);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+// Frame profiler. A ProfileScope records a CPU span, on whatever thread it
+// runs on, into the current frame; counters carry per-frame values measured
+// elsewhere, such as GPU pass times. The last few seconds of frames are kept
+// for the overlay's percentiles and graph, and for trace export.
+class ProfileScope {
+public:
+  explicit ProfileScope(const char *name) noexcept; // A string literal
+  ~ProfileScope();
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  const char *name;
+  std::int64_t start; // Microseconds since the profiler started
+};
+
+void BeginProfilerFrame(); // Main thread, once per frame; ends the last one
+void RecordProfilerCounter(const char *name, float value); // This frame's
+// Frame times (p50/p95/p99 and a graph) and per-scope CPU time
+void DrawProfilerOverlay(int x, int y);
+// The kept frames as Chrome trace-event JSON (chrome://tracing, Perfetto)
+bool ExportProfilerTrace(const std::filesystem::path &path);
+
+inline bool profilerOverlay = false; // Toggle with F3; F4 exports
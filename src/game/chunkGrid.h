@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <utility>
+
+// Loaded chunks in a fixed toroidal grid: chunk (cx, cz) lives in slot
+// (cx mod size, cz mod size). Any set of chunks spanning fewer than size
+// chunks per axis gets a slot each, so as long as streaming keeps the loaded
+// set that tight (at most 27 across, see chunkStreaming.cpp) a lookup is one
+// index and one coordinate compare, and the allocator is never touched.
+//
+// Templated on the chunk type so it doesn't depend on game.h; the chunk only
+// needs int x and z members.
+template <typename T, int Size> class ChunkGrid {
+  static_assert(Size > 0 && (Size & (Size - 1)) == 0, "Size must be a power of two");
+
+public:
+  static constexpr int size = Size;
+
+  [[nodiscard]] T *find(int cx, int cz) noexcept {
+    const int slot = slotOf(cx, cz);
+    return loaded[slot] && slots[slot].x == cx && slots[slot].z == cz ? &slots[slot]
+                                                                      : nullptr;
+  }
+  [[nodiscard]] const T *find(int cx, int cz) const noexcept {
+    return const_cast<ChunkGrid *>(this)->find(cx, cz);
+  }
+  [[nodiscard]] bool contains(int cx, int cz) const noexcept {
+    return find(cx, cz) != nullptr;
+  }
+  [[nodiscard]] int count() const noexcept { return loadedCount; }
+  // Whatever chunk holds (cx, cz)'s slot, which insert() would displace
+  [[nodiscard]] const T *occupant(int cx, int cz) const noexcept {
+    const int slot = slotOf(cx, cz);
+    return loaded[slot] ? &slots[slot] : nullptr;
+  }
+
+  // Stores the chunk in its slot and returns the chunk it displaced, if any
+  std::optional<T> insert(T &&chunk) {
+    const int slot = slotOf(chunk.x, chunk.z);
+    std::optional<T> displaced;
+    if (loaded[slot]) {
+      displaced = std::move(slots[slot]);
+    } else {
+      loaded[slot] = true;
+      ++loadedCount;
+    }
+    slots[slot] = std::move(chunk);
+    return displaced;
+  }
+
+  std::optional<T> erase(int cx, int cz) {
+    if (find(cx, cz) == nullptr) {
+      return std::nullopt;
+    }
+    const int slot = slotOf(cx, cz);
+    loaded[slot] = false;
+    --loadedCount;
+    return std::move(slots[slot]);
+  }
+
+  // Every loaded chunk, in slot (memory) order
+  template <typename Fn> void forEach(Fn &&fn) {
+    for (int slot = 0; slot < size * size; ++slot) {
+      if (loaded[slot]) {
+        fn(slots[slot]);
+      }
+    }
+  }
+
+  // Every loaded chunk, nearest slots to (cx, cz) first. Each slot is
+  // visited once, whatever chunk it holds.
+  template <typename Fn> void forEachNearToFar(int cx, int cz, Fn &&fn) {
+    for (const auto &[dx, dz] : nearToFar) {
+      const int slot = slotOf(cx + dx, cz + dz);
+      if (loaded[slot]) {
+        fn(slots[slot]);
+      }
+    }
+  }
+
+  // Empties every slot; the caller releases the chunks first
+  void clear() noexcept {
+    loaded.fill(false);
+    loadedCount = 0;
+  }
+
+private:
+  [[nodiscard]] static constexpr int slotOf(int cx, int cz) noexcept {
+    // Two's complement & is a mod that works for negative coordinates too
+    return (cz & (size - 1)) * size + (cx & (size - 1));
+  }
+
+  // One offset per slot, [-size/2, size/2) on both axes, sorted by distance
+  static inline const std::array<std::pair<int, int>, Size * Size> nearToFar = [] {
+    std::array<std::pair<int, int>, Size * Size> offsets{};
+    for (int i = 0; i < size * size; ++i) {
+      offsets[i] = {i % size - size / 2, i / size - size / 2};
+    }
+    std::stable_sort(offsets.begin(), offsets.end(), [](const auto &a, const auto &b) {
+      return a.first * a.first + a.second * a.second <
+             b.first * b.first + b.second * b.second;
+    });
+    return offsets;
+  }();
+
+  std::array<T, Size * Size> slots{};
+  std::array<bool, Size * Size> loaded{};
+  int loadedCount = 0;
+};
@@ -0,0 +1,131 @@
+#include "../core/profiler.h"
+#include "game.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+
+// Decides which chunks should be loaded. The plan only changes when the
+// camera (or the point it is heading for) enters another chunk, or the render
+// distance changes; between those nothing is scanned. Both radii are square,
+// like the load window always was, and unloading waits until a chunk is
+// chunkUnloadHysteresis chunks outside it, so walking along a chunk border
+// doesn't reload the same row over and over.
+
+constexpr int stride = 31;
+constexpr float prefetchSeconds = 4.0f; // How far ahead of the player to load
+constexpr float viewPriorityWeight = 1.0f; // Straight ahead counts as 1/(1+w) as far
+
+struct StreamingPlan {
+  int cx, cz;             // Camera chunk
+  int aheadX, aheadZ;     // Chunk the camera is heading for
+  int renderDistance;
+};
+
+static std::optional<StreamingPlan> currentPlan;
+static ChunkStreamingStats stats{};
+static int plannedThisWindow = 0;
+static int loadedThisWindow = 0;
+static int evictedThisWindow = 0;
+static double windowStart = 0.0;
+
+[[nodiscard]] static int chunkOf(float w) noexcept {
+  return static_cast<int>(std::floor(w / stride));
+}
+
+[[nodiscard]] static int chebyshev(int ax, int az, int bx, int bz) noexcept {
+  return std::max(std::abs(ax - bx), std::abs(az - bz));
+}
+
+// Unloaded, cancelled and dropped: outside the unload radius of both where
+// the player is and where they are heading
+[[nodiscard]] static bool isOutOfRange(const StreamingPlan &plan, int chunkX, int chunkZ) noexcept {
+  const int unloadRadius = plan.renderDistance + chunkUnloadHysteresis;
+  return chebyshev(chunkX, chunkZ, plan.cx, plan.cz) > unloadRadius &&
+         chebyshev(chunkX, chunkZ, plan.aheadX, plan.aheadZ) > unloadRadius;
+}
+
+void ResetChunkStreaming() { currentPlan.reset(); }
+
+int GetFogChunkRadius() noexcept {
+  // From anywhere in its chunk the camera can be right at the border, so a
+  // chunk n over is as close as (n - 1) strides
+  return std::max(static_cast<int>(std::ceil(fog.end / stride)), 1);
+}
+
+void UpdateChunkStreaming(const Camera &camera, float yaw, int renderDistance) {
+  const ProfileScope scope("chunk streaming");
+  // Where the player will be shortly. Clamped to less than the hysteresis, so
+  // chunks prefetched for it are still kept if the player stops.
+  const float maxLead = static_cast<float>(std::max(chunkUnloadHysteresis - 1, 0) * stride);
+  Vector2 lead = {playerVelocity.x * prefetchSeconds, playerVelocity.z * prefetchSeconds};
+  if (Vector2Length(lead) > maxLead) {
+    lead = Vector2Scale(Vector2Normalize(lead), maxLead);
+  }
+  const Vector2 ahead = {camera.position.x + lead.x, camera.position.z + lead.y};
+
+  const StreamingPlan plan = {chunkOf(camera.position.x), chunkOf(camera.position.z),
+                              chunkOf(ahead.x), chunkOf(ahead.y), renderDistance};
+  if (!currentPlan || currentPlan->cx != plan.cx || currentPlan->cz != plan.cz ||
+      currentPlan->aheadX != plan.aheadX || currentPlan->aheadZ != plan.aheadZ ||
+      currentPlan->renderDistance != plan.renderDistance) {
+    currentPlan = plan;
+    ++stats.replans;
+
+    // Keep: within the unload radius of where the player is or is heading
+    CancelChunkRequests(
+        [&plan](int chunkX, int chunkZ) { return isOutOfRange(plan, chunkX, chunkZ); });
+    chunks.forEach([&](Chunk &chunk) {
+      if (isOutOfRange(plan, chunk.x, chunk.z)) {
+        unloadChunk(chunk);
+        chunks.erase(chunk.x, chunk.z);
+        ++evictedThisWindow;
+      }
+    });
+
+    // Load: the render window around both, nearest to the predicted position
+    // and most in view first
+    const Vector2 forward = {std::sin(yaw), std::cos(yaw)};
+    const auto priority = [&ahead, &forward](int chunkX, int chunkZ) {
+      const Vector2 toChunk = {
+          static_cast<float>(chunkX * stride + stride / 2) - ahead.x,
+          static_cast<float>(chunkZ * stride + stride / 2) - ahead.y};
+      const float distance = Vector2Length(toChunk);
+      const float facing = distance > 0.0f
+                               ? std::max(0.0f, Vector2DotProduct(toChunk, forward) / distance)
+                               : 1.0f;
+      return distance / (1.0f + viewPriorityWeight * facing);
+    };
+    PrioritizeChunkRequests(priority);
+
+    for (const auto &[centreX, centreZ] : {std::pair{plan.cx, plan.cz},
+                                          std::pair{plan.aheadX, plan.aheadZ}}) {
+      for (int dz = -renderDistance; dz <= renderDistance; ++dz) {
+        for (int dx = -renderDistance; dx <= renderDistance; ++dx) {
+          const int chunkX = centreX + dx;
+          const int chunkZ = centreZ + dz;
+          if (!chunks.contains(chunkX, chunkZ) &&
+              RequestChunk(chunkX, chunkZ, priority(chunkX, chunkZ))) {
+            ++plannedThisWindow;
+          }
+        }
+      }
+    }
+  }
+
+  loadedThisWindow += UploadReadyChunks(
+      [&plan](int chunkX, int chunkZ) { return isOutOfRange(plan, chunkX, chunkZ); });
+
+  // Per-second counters over one-second windows
+  const double now = GetTime();
+  if (now - windowStart >= 1.0) {
+    const auto elapsed = static_cast<float>(now - windowStart);
+    stats.plannedPerSecond = static_cast<float>(plannedThisWindow) / elapsed;
+    stats.loadedPerSecond = static_cast<float>(loadedThisWindow) / elapsed;
+    stats.evictedPerSecond = static_cast<float>(evictedThisWindow) / elapsed;
+    plannedThisWindow = loadedThisWindow = evictedThisWindow = 0;
+    windowStart = now;
+  }
+}
+
+ChunkStreamingStats GetChunkStreamingStats() { return stats; }
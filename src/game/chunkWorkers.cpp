@@ -0,0 +1,213 @@
+#include "game.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Worker threads build the CPU half of a chunk (noise, smoothing, colors,
+// normals, indices, vegetation). The main thread only does the GPU upload.
+static std::vector<std::thread> chunkWorkers;
+static std::mutex chunkQueueMutex;
+static std::condition_variable jobAvailable;
+static std::condition_variable jobFinished;
+// Binary heap, most urgent (lowest priority value) first
+struct ChunkJob {
+  int cx, cz;
+  float priority;
+};
+static std::vector<ChunkJob> pendingJobs;
+static std::deque<ChunkBuild> readyBuilds;
+static int inFlightJobs = 0;
+static bool stopChunkWorkers = false;
+
+[[nodiscard]] static bool jobAfter(const ChunkJob &a, const ChunkJob &b) noexcept {
+  return a.priority > b.priority;
+}
+
+// Main thread only: everything requested but not uploaded (or cancelled) yet
+static std::unordered_set<std::pair<int, int>, pair_hash> requestedChunks;
+
+static void ChunkWorkerLoop() {
+  for (;;) {
+    ChunkJob job;
+    {
+      std::unique_lock lock(chunkQueueMutex);
+      jobAvailable.wait(lock,
+                        [] { return stopChunkWorkers || !pendingJobs.empty(); });
+      if (stopChunkWorkers) {
+        return;
+      }
+      std::pop_heap(pendingJobs.begin(), pendingJobs.end(), jobAfter);
+      job = pendingJobs.back();
+      pendingJobs.pop_back();
+      ++inFlightJobs;
+    }
+
+    ChunkBuild build = buildChunk(job.cx, job.cz);
+
+    {
+      std::lock_guard lock(chunkQueueMutex);
+      readyBuilds.push_back(std::move(build));
+      --inFlightJobs;
+    }
+    jobFinished.notify_all();
+  }
+}
+
+void InitChunkWorkers() {
+  // Leave one core for the main thread
+  const unsigned int hw = std::thread::hardware_concurrency();
+  const unsigned int count = std::max(1u, hw > 1 ? hw - 1 : 1u);
+
+  stopChunkWorkers = false;
+  for (unsigned int i = 0; i < count; ++i) {
+    chunkWorkers.emplace_back(ChunkWorkerLoop);
+  }
+
+  std::cout << "Chunk workers started: " << count << std::endl;
+}
+
+void ShutdownChunkWorkers() {
+  {
+    std::lock_guard lock(chunkQueueMutex);
+    stopChunkWorkers = true;
+    pendingJobs.clear();
+  }
+  jobAvailable.notify_all();
+
+  for (auto &worker : chunkWorkers) {
+    worker.join();
+  }
+  chunkWorkers.clear();
+
+  for (auto &build : readyBuilds) {
+    discardChunkBuild(build);
+  }
+  readyBuilds.clear();
+  requestedChunks.clear();
+  inFlightJobs = 0;
+}
+
+bool RequestChunk(int cx, int cz, float priority) {
+  if (!requestedChunks.insert({cx, cz}).second) {
+    return false; // Already pending, in flight or waiting for upload
+  }
+
+  {
+    std::lock_guard lock(chunkQueueMutex);
+    pendingJobs.push_back({cx, cz, priority});
+    std::push_heap(pendingJobs.begin(), pendingJobs.end(), jobAfter);
+  }
+  jobAvailable.notify_one();
+  return true;
+}
+
+void PrioritizeChunkRequests(const std::function<float(int, int)> &priority) {
+  std::lock_guard lock(chunkQueueMutex);
+  for (ChunkJob &job : pendingJobs) {
+    job.priority = priority(job.cx, job.cz);
+  }
+  std::make_heap(pendingJobs.begin(), pendingJobs.end(), jobAfter);
+}
+
+void CancelChunkRequests(const std::function<bool(int, int)> &shouldCancel) {
+  std::vector<ChunkBuild> cancelled;
+  {
+    std::lock_guard lock(chunkQueueMutex);
+
+    std::erase_if(pendingJobs, [&](const ChunkJob &job) {
+      if (!shouldCancel(job.cx, job.cz)) {
+        return false;
+      }
+      requestedChunks.erase({job.cx, job.cz});
+      return true;
+    });
+    std::make_heap(pendingJobs.begin(), pendingJobs.end(), jobAfter);
+
+    // In-flight jobs can't be stopped; they land here on a later frame
+    for (auto it = readyBuilds.begin(); it != readyBuilds.end();) {
+      if (shouldCancel(it->chunk.x, it->chunk.z)) {
+        requestedChunks.erase({it->chunk.x, it->chunk.z});
+        cancelled.push_back(std::move(*it));
+        it = readyBuilds.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  for (auto &build : cancelled) {
+    discardChunkBuild(build);
+  }
+}
+
+static bool PopReadyBuild(ChunkBuild &out) {
+  std::lock_guard lock(chunkQueueMutex);
+  if (readyBuilds.empty()) {
+    return false;
+  }
+  out = std::move(readyBuilds.front());
+  readyBuilds.pop_front();
+  return true;
+}
+
+int UploadReadyChunks(const std::function<bool(int, int)> &isOutOfRange) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  const auto budget = std::chrono::microseconds(chunkUploadBudgetUs);
+
+  int uploaded = 0;
+  while (uploaded < chunkUploadsPerFrame) {
+    // Always upload at least one chunk so a tiny budget can't stall streaming
+    if (uploaded > 0 && Clock::now() - start >= budget) {
+      break;
+    }
+
+    ChunkBuild build;
+    if (!PopReadyBuild(build)) {
+      break;
+    }
+    const int cx = build.chunk.x;
+    const int cz = build.chunk.z;
+    requestedChunks.erase({cx, cz});
+
+    // Cancelling can't reach builds in flight, so after a teleport or a fast
+    // run some finish for a window the player has already left. Uploaded,
+    // they would take the ring slot of a loaded chunk that is in range.
+    const Chunk *occupant = chunks.occupant(cx, cz);
+    if (isOutOfRange(cx, cz) ||
+        (occupant != nullptr && !isOutOfRange(occupant->x, occupant->z))) {
+      discardChunkBuild(build);
+      continue;
+    }
+    uploadChunk(std::move(build));
+    ++uploaded;
+  }
+  return uploaded;
+}
+
+void WaitForChunkRequests() {
+  while (!requestedChunks.empty()) {
+    {
+      std::unique_lock lock(chunkQueueMutex);
+      jobFinished.wait(lock, [] { return !readyBuilds.empty(); });
+    }
+
+    ChunkBuild build;
+    while (PopReadyBuild(build)) {
+      requestedChunks.erase({build.chunk.x, build.chunk.z});
+      uploadChunk(std::move(build));
+    }
+  }
+}
+
+ChunkQueueStats GetChunkQueueStats() {
+  std::lock_guard lock(chunkQueueMutex);
+  return {static_cast<int>(pendingJobs.size()), inFlightJobs,
+          static_cast<int>(readyBuilds.size())};
+}
@@ -31,11 +31,19 @@
  *
  * The implementation has template specializations to work with either floats or doubles,
  * depending on the desired accuracy.
+ *
+ * For bulk work there is also a batched 2D float API, `perlin_batch` and `perlin_grid`.
+ * It evaluates several points at once using SSE2 or AVX2 lanes (picked at runtime on x86)
+ * and falls back to the scalar template elsewhere. All paths return results bit-identical
+ * to calling `perlin(x, y)` point by point, as long as the scalar code is not compiled with
+ * FMA contraction (e.g. `-march=native` together with `-ffp-contract=fast`).
  */
 
 #ifndef DB_PERLIN_HPP
 #define DB_PERLIN_HPP
 
+#include <cstddef>
+
 namespace db {
     template<typename T>
     constexpr auto perlin(T x) -> T;
@@ -45,6 +53,20 @@ namespace db {
 
     template<typename T>
     constexpr auto perlin(T x, T y, T z) -> T;
+
+    // out[i] = perlin(xs[i], ys[i]) for i in [0, n).
+    auto perlin_batch(float const* xs, float const* ys, float* out, std::size_t n) -> void;
+
+    // Same as `perlin_batch`, but always uses the scalar template (reference/benchmark path).
+    auto perlin_batch_scalar(float const* xs, float const* ys, float* out, std::size_t n) -> void;
+
+    // Row-major w*h grid: out[j*w + i] = perlin((x0 + i*step) * frequency + offset,
+    //                                          (y0 + j*step) * frequency + offset).
+    auto perlin_grid(float x0, float y0, float step, float frequency, float offset,
+                     std::size_t w, std::size_t h, float* out) -> void;
+
+    // Name of the instruction set `perlin_batch` dispatches to ("avx2", "sse2" or "scalar").
+    auto perlin_batch_isa() -> char const*;
 }
 
 #ifdef DB_PERLIN_IMPL
@@ -269,6 +291,263 @@ namespace db {
     }
 }
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DB_PERLIN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace db {
+    auto perlin_batch_scalar(float const* xs, float const* ys, float* out, std::size_t n) -> void {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = perlin(xs[i], ys[i]);
+        }
+    }
+
+#ifdef DB_PERLIN_X86
+    // The SIMD paths below mirror the scalar template operation for operation, in the same
+    // order, so every lane rounds exactly like `perlin<float>(x, y)` does.
+
+    // 32-bit copy of the permutation table for AVX2 gathers.
+    struct perm32_table { int v[512]; };
+    static constexpr perm32_table p32 = [] {
+        perm32_table t{};
+        for (int i = 0; i < 512; ++i) {
+            t.v[i] = p[i];
+        }
+        return t;
+    }();
+
+    static inline auto select_sse2(__m128 mask, __m128 a, __m128 b) -> __m128 {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    static inline auto dot_grad_sse2(__m128i hash, __m128 xf, __m128 yf) -> __m128 {
+        // Same 8 cases as the scalar `dot_grad`, each computed the same way, then picked per lane.
+        __m128 const sign = _mm_set1_ps(-0.0f);
+        __m128 const nx = _mm_xor_ps(xf, sign);
+        __m128 const ny = _mm_xor_ps(yf, sign);
+
+        __m128 const c0 = _mm_add_ps(xf, yf);
+        __m128 const c2 = _mm_sub_ps(xf, yf);
+        __m128 const c4 = _mm_sub_ps(nx, yf);
+        __m128 const c6 = _mm_add_ps(nx, yf);
+
+        __m128i const one = _mm_set1_epi32(1);
+        __m128 const b0 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hash, one), one));
+        __m128 const b1 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_srli_epi32(hash, 1), one), one));
+        __m128 const b2 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_srli_epi32(hash, 2), one), one));
+
+        __m128 const c01 = select_sse2(b0, xf, c0);
+        __m128 const c23 = select_sse2(b0, ny, c2);
+        __m128 const c45 = select_sse2(b0, nx, c4);
+        __m128 const c67 = select_sse2(b0, yf, c6);
+        __m128 const c03 = select_sse2(b1, c23, c01);
+        __m128 const c47 = select_sse2(b1, c67, c45);
+        return select_sse2(b2, c47, c03);
+    }
+
+    static inline auto fade_sse2(__m128 t) -> __m128 {
+        __m128 const inner = _mm_add_ps(
+            _mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+            _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+    }
+
+    static inline auto lerp_sse2(__m128 a, __m128 b, __m128 t) -> __m128 {
+        return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+    }
+
+    static inline auto floor_sse2(__m128 x) -> __m128i {
+        __m128i const xi = _mm_cvttps_epi32(x);
+        __m128 const less = _mm_cmplt_ps(x, _mm_cvtepi32_ps(xi));
+        return _mm_add_epi32(xi, _mm_castps_si128(less)); // mask is -1 where x < xi
+    }
+
+    static inline auto perlin_sse2(__m128 x, __m128 y) -> __m128 {
+        __m128i const xi0 = floor_sse2(x);
+        __m128i const yi0 = floor_sse2(y);
+
+        __m128 const one = _mm_set1_ps(1.0f);
+        __m128 const xf0 = _mm_sub_ps(x, _mm_cvtepi32_ps(xi0));
+        __m128 const yf0 = _mm_sub_ps(y, _mm_cvtepi32_ps(yi0));
+        __m128 const xf1 = _mm_sub_ps(xf0, one);
+        __m128 const yf1 = _mm_sub_ps(yf0, one);
+
+        __m128i const mask = _mm_set1_epi32(0xFF);
+        alignas(16) int xi[4];
+        alignas(16) int yi[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(xi), _mm_and_si128(xi0, mask));
+        _mm_store_si128(reinterpret_cast<__m128i*>(yi), _mm_and_si128(yi0, mask));
+
+        __m128 const u = fade_sse2(xf0);
+        __m128 const v = fade_sse2(yf0);
+
+        // SSE2 has no gather, so the table lookups stay scalar.
+        alignas(16) int h00[4], h01[4], h10[4], h11[4];
+        for (int l = 0; l < 4; ++l) {
+            h00[l] = p[p[xi[l] + 0] + yi[l] + 0];
+            h01[l] = p[p[xi[l] + 0] + yi[l] + 1];
+            h10[l] = p[p[xi[l] + 1] + yi[l] + 0];
+            h11[l] = p[p[xi[l] + 1] + yi[l] + 1];
+        }
+
+        __m128 const x1 = lerp_sse2(
+            dot_grad_sse2(_mm_load_si128(reinterpret_cast<__m128i const*>(h00)), xf0, yf0),
+            dot_grad_sse2(_mm_load_si128(reinterpret_cast<__m128i const*>(h10)), xf1, yf0), u);
+        __m128 const x2 = lerp_sse2(
+            dot_grad_sse2(_mm_load_si128(reinterpret_cast<__m128i const*>(h01)), xf0, yf1),
+            dot_grad_sse2(_mm_load_si128(reinterpret_cast<__m128i const*>(h11)), xf1, yf1), u);
+        return lerp_sse2(x1, x2, v);
+    }
+
+    static auto perlin_batch_sse2(float const* xs, float const* ys, float* out, std::size_t n) -> void {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(out + i, perlin_sse2(_mm_loadu_ps(xs + i), _mm_loadu_ps(ys + i)));
+        }
+        perlin_batch_scalar(xs + i, ys + i, out + i, n - i);
+    }
+
+    // No "fma" in the target list on purpose: contracting mul+add would break bit-identity.
+#define DB_PERLIN_AVX2 __attribute__((target("avx2")))
+
+    DB_PERLIN_AVX2 static inline auto dot_grad_avx2(__m256i hash, __m256 xf, __m256 yf) -> __m256 {
+        __m256 const sign = _mm256_set1_ps(-0.0f);
+        __m256 const nx = _mm256_xor_ps(xf, sign);
+        __m256 const ny = _mm256_xor_ps(yf, sign);
+
+        __m256 const c0 = _mm256_add_ps(xf, yf);
+        __m256 const c2 = _mm256_sub_ps(xf, yf);
+        __m256 const c4 = _mm256_sub_ps(nx, yf);
+        __m256 const c6 = _mm256_add_ps(nx, yf);
+
+        // Move hash bits 0..2 into the sign bit so blendv can use them directly.
+        __m256 const b0 = _mm256_castsi256_ps(_mm256_slli_epi32(hash, 31));
+        __m256 const b1 = _mm256_castsi256_ps(_mm256_slli_epi32(hash, 30));
+        __m256 const b2 = _mm256_castsi256_ps(_mm256_slli_epi32(hash, 29));
+
+        __m256 const c01 = _mm256_blendv_ps(c0, xf, b0);
+        __m256 const c23 = _mm256_blendv_ps(c2, ny, b0);
+        __m256 const c45 = _mm256_blendv_ps(c4, nx, b0);
+        __m256 const c67 = _mm256_blendv_ps(c6, yf, b0);
+        __m256 const c03 = _mm256_blendv_ps(c01, c23, b1);
+        __m256 const c47 = _mm256_blendv_ps(c45, c67, b1);
+        return _mm256_blendv_ps(c03, c47, b2);
+    }
+
+    DB_PERLIN_AVX2 static inline auto fade_avx2(__m256 t) -> __m256 {
+        __m256 const inner = _mm256_add_ps(
+            _mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))),
+            _mm256_set1_ps(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    }
+
+    DB_PERLIN_AVX2 static inline auto lerp_avx2(__m256 a, __m256 b, __m256 t) -> __m256 {
+        return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+    }
+
+    DB_PERLIN_AVX2 static inline auto floor_avx2(__m256 x) -> __m256i {
+        __m256i const xi = _mm256_cvttps_epi32(x);
+        __m256 const less = _mm256_cmp_ps(x, _mm256_cvtepi32_ps(xi), _CMP_LT_OQ);
+        return _mm256_add_epi32(xi, _mm256_castps_si256(less));
+    }
+
+    DB_PERLIN_AVX2 static inline auto perlin_avx2(__m256 x, __m256 y) -> __m256 {
+        __m256i const xi0 = floor_avx2(x);
+        __m256i const yi0 = floor_avx2(y);
+
+        __m256 const one = _mm256_set1_ps(1.0f);
+        __m256 const xf0 = _mm256_sub_ps(x, _mm256_cvtepi32_ps(xi0));
+        __m256 const yf0 = _mm256_sub_ps(y, _mm256_cvtepi32_ps(yi0));
+        __m256 const xf1 = _mm256_sub_ps(xf0, one);
+        __m256 const yf1 = _mm256_sub_ps(yf0, one);
+
+        __m256i const mask = _mm256_set1_epi32(0xFF);
+        __m256i const ione = _mm256_set1_epi32(1);
+        __m256i const xi = _mm256_and_si256(xi0, mask);
+        __m256i const yi = _mm256_and_si256(yi0, mask);
+
+        __m256 const u = fade_avx2(xf0);
+        __m256 const v = fade_avx2(yf0);
+
+        __m256i const a = _mm256_add_epi32(_mm256_i32gather_epi32(p32.v, xi, 4), yi);
+        __m256i const b = _mm256_add_epi32(_mm256_i32gather_epi32(p32.v, _mm256_add_epi32(xi, ione), 4), yi);
+        __m256i const h00 = _mm256_i32gather_epi32(p32.v, a, 4);
+        __m256i const h01 = _mm256_i32gather_epi32(p32.v, _mm256_add_epi32(a, ione), 4);
+        __m256i const h10 = _mm256_i32gather_epi32(p32.v, b, 4);
+        __m256i const h11 = _mm256_i32gather_epi32(p32.v, _mm256_add_epi32(b, ione), 4);
+
+        __m256 const x1 = lerp_avx2(dot_grad_avx2(h00, xf0, yf0), dot_grad_avx2(h10, xf1, yf0), u);
+        __m256 const x2 = lerp_avx2(dot_grad_avx2(h01, xf0, yf1), dot_grad_avx2(h11, xf1, yf1), u);
+        return lerp_avx2(x1, x2, v);
+    }
+
+    DB_PERLIN_AVX2 static auto perlin_batch_avx2(float const* xs, float const* ys, float* out, std::size_t n) -> void {
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(out + i, perlin_avx2(_mm256_loadu_ps(xs + i), _mm256_loadu_ps(ys + i)));
+        }
+        perlin_batch_sse2(xs + i, ys + i, out + i, n - i);
+    }
+
+#undef DB_PERLIN_AVX2
+#endif // DB_PERLIN_X86
+
+    using perlin_batch_fn = auto (*)(float const*, float const*, float*, std::size_t) -> void;
+
+    struct perlin_dispatch {
+        perlin_batch_fn fn;
+        char const* isa;
+    };
+
+    static auto select_perlin_batch() -> perlin_dispatch {
+#ifdef DB_PERLIN_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {perlin_batch_avx2, "avx2"};
+        }
+        return {perlin_batch_sse2, "sse2"};
+#else
+        return {perlin_batch_scalar, "scalar"};
+#endif
+    }
+
+    static auto perlin_batch_impl() -> perlin_dispatch const& {
+        static perlin_dispatch const dispatch = select_perlin_batch();
+        return dispatch;
+    }
+
+    auto perlin_batch(float const* xs, float const* ys, float* out, std::size_t n) -> void {
+        perlin_batch_impl().fn(xs, ys, out, n);
+    }
+
+    auto perlin_batch_isa() -> char const* {
+        return perlin_batch_impl().isa;
+    }
+
+    auto perlin_grid(float x0, float y0, float step, float frequency, float offset,
+                     std::size_t w, std::size_t h, float* out) -> void {
+        // Rows are fed to `perlin_batch` in fixed-size pieces to stay allocation-free.
+        constexpr std::size_t piece = 64;
+        float xs[piece];
+        float ys[piece];
+
+        for (std::size_t j = 0; j < h; ++j) {
+            float const y = (y0 + float(j) * step) * frequency + offset;
+            for (std::size_t i0 = 0; i0 < w; i0 += piece) {
+                std::size_t const count = (w - i0 < piece) ? w - i0 : piece;
+                for (std::size_t i = 0; i < count; ++i) {
+                    xs[i] = (x0 + float(i0 + i) * step) * frequency + offset;
+                    ys[i] = y;
+                }
+                perlin_batch(xs, ys, out + j * w + i0, count);
+            }
+        }
+    }
+}
+
+#undef DB_PERLIN_X86
+
 template auto db::perlin<float>(float x) -> float;
 template auto db::perlin<float>(float x, float y) -> float;
 template auto db::perlin<float>(float x, float y, float z) -> float;
@@ -1,18 +1,26 @@
+#include "../core/profiler.h"
 #include "game.h"
 #include "raymath.h"
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
+#include <vector>
 
-struct Frustum {
-  std::array<Vector4, 6> planes; // left, right, bottom, top, near, far
-};
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RAVEN_CULL_SSE2 1
+#endif
+
+constexpr float frustumNear = 0.1f;
+
+[[nodiscard]] Matrix GetCameraProjection(const Camera &camera, float aspect) noexcept {
+  return MatrixPerspective(camera.fovy * DEG2RAD, aspect, frustumNear, fog.end);
+}
 
-[[nodiscard]] Frustum ExtractFrustum(const Camera &camera) noexcept {
-  const Matrix viewProj = MatrixMultiply(
-      GetCameraMatrix(camera),
-      MatrixPerspective(camera.fovy * DEG2RAD,
-                        static_cast<float>(GetScreenWidth()) / static_cast<float>(GetScreenHeight()), 
-                        0.1f, 1000.0f));
+[[nodiscard]] Frustum ExtractFrustum(const Camera &camera, float aspect) noexcept {
+  const Matrix viewProj =
+      MatrixMultiply(GetCameraMatrix(camera), GetCameraProjection(camera, aspect));
 
   Frustum frustum;
   // Left plane
@@ -48,39 +56,129 @@ struct Frustum {
   return frustum;
 }
 
-[[nodiscard]] bool IsChunkInFrustum(const Chunk &chunk, const Camera &camera) noexcept {
-  const Frustum frustum = ExtractFrustum(camera);
-
-  // Chunk bounding box (world space)
-  const Vector3 chunkPos = {static_cast<float>(chunk.x * 31), 0.0f, static_cast<float>(chunk.z * 31)};
-  constexpr float minY = 0.0f;
-  constexpr float maxY = 40.0f;
-
-  const std::array<Vector3, 8> corners = {{
-      {chunkPos.x, minY, chunkPos.z},
-      {chunkPos.x + 31, minY, chunkPos.z},
-      {chunkPos.x, minY, chunkPos.z + 31},
-      {chunkPos.x + 31, minY, chunkPos.z + 31},
-      {chunkPos.x, maxY, chunkPos.z},
-      {chunkPos.x + 31, maxY, chunkPos.z},
-      {chunkPos.x, maxY, chunkPos.z + 31},
-      {chunkPos.x + 31, maxY, chunkPos.z + 31}
-  }};
-
-  // Test against all 6 frustum planes
-  for (const auto &plane : frustum.planes) {
-    int out = 0;
-    for (const auto &corner : corners) {
-      const float dist = plane.x * corner.x + plane.y * corner.y + 
-                        plane.z * corner.z + plane.w;
-      if (dist < 0) {
-        ++out;
-      }
+// Loaded chunks' bounds, structure-of-arrays, gathered near to far each frame
+// from the height range recorded at generation (vegetation included)
+struct ChunkBoundsSoA {
+  std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+  std::vector<const Chunk *> chunkRefs;
+
+  void clear() {
+    for (auto *axis : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+      axis->clear();
+    }
+    chunkRefs.clear();
+  }
+
+  void push(const Chunk &chunk) {
+    constexpr float stride = 31.0f;
+    const float x = static_cast<float>(chunk.x) * stride;
+    const float z = static_cast<float>(chunk.z) * stride;
+    minX.push_back(x);
+    minY.push_back(chunk.minHeight);
+    minZ.push_back(z);
+    maxX.push_back(x + stride);
+    maxY.push_back(chunk.contentTop);
+    maxZ.push_back(z + stride);
+    chunkRefs.push_back(&chunk);
+  }
+};
+
+static ChunkBoundsSoA bounds;
+static std::vector<unsigned char> visibleFlags;
+static std::vector<const Chunk *> visibleChunks;
+static CullingStats cullingStats{};
+
+// p-vertex test: per plane, the box corner furthest along the normal is
+// picked by the normal's signs, which are the same for every box. So each
+// plane selects whole min/max arrays once and the inner loop is just
+// multiply-adds. A box is culled if its p-vertex is behind any plane. (The
+// n-vertex would only tell "inside" from "intersecting", which drawing
+// doesn't need.)
+static void CullBounds(const Frustum &frustum, std::span<unsigned char> visible) {
+  const std::size_t count = bounds.chunkRefs.size();
+  std::array<const float *, 6> px, py, pz; // Per plane
+  for (std::size_t p = 0; p < frustum.planes.size(); ++p) {
+    const Vector4 &plane = frustum.planes[p];
+    px[p] = plane.x >= 0.0f ? bounds.maxX.data() : bounds.minX.data();
+    py[p] = plane.y >= 0.0f ? bounds.maxY.data() : bounds.minY.data();
+    pz[p] = plane.z >= 0.0f ? bounds.maxZ.data() : bounds.minZ.data();
+  }
+
+  std::size_t i = 0;
+#ifdef RAVEN_CULL_SSE2
+  for (; i + 4 <= count; i += 4) {
+    __m128 outside = _mm_setzero_ps();
+    for (std::size_t p = 0; p < frustum.planes.size(); ++p) {
+      const Vector4 &plane = frustum.planes[p];
+      const __m128 dist = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(px[p] + i)),
+                     _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(py[p] + i))),
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(pz[p] + i)),
+                     _mm_set1_ps(plane.w)));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
     }
-    if (out == 8) {
-      return false; // All corners outside this plane
+    const int mask = _mm_movemask_ps(outside);
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+      visible[i + lane] = (mask >> lane & 1) == 0;
     }
   }
+#endif
+  for (; i < count; ++i) {
+    bool inside = true;
+    for (std::size_t p = 0; p < frustum.planes.size(); ++p) {
+      const Vector4 &plane = frustum.planes[p];
+      inside = inside && plane.x * px[p][i] + plane.y * py[p][i] +
+                                 plane.z * pz[p][i] + plane.w >= 0.0f;
+    }
+    visible[i] = inside;
+  }
+}
 
-  return true;
+float ChunkDistance(const Chunk &chunk, Vector3 eye) noexcept {
+  constexpr float stride = 31.0f;
+  const float minX = static_cast<float>(chunk.x) * stride;
+  const float minZ = static_cast<float>(chunk.z) * stride;
+  const float dx = std::max({minX - eye.x, 0.0f, eye.x - (minX + stride)});
+  const float dy = std::max({chunk.minHeight - eye.y, 0.0f, eye.y - chunk.contentTop});
+  const float dz = std::max({minZ - eye.z, 0.0f, eye.z - (minZ + stride)});
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
 }
+
+std::span<const Chunk *const> CullChunks(const Camera &camera, float aspect) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  const ProfileScope scope("frustum culling");
+
+  const Frustum frustum = ExtractFrustum(camera, aspect);
+
+  // The far plane only cuts straight ahead; chunks off to the side can be
+  // inside it and still entirely in the fog
+  constexpr float stride = 31.0f;
+  const Vector3 &eye = camera.position;
+  bounds.clear();
+  chunks.forEachNearToFar(
+      static_cast<int>(std::floor(eye.x / stride)), static_cast<int>(std::floor(eye.z / stride)),
+      [&eye](const Chunk &chunk) {
+        if (ChunkDistance(chunk, eye) < fog.end) {
+          bounds.push(chunk);
+        }
+      });
+
+  visibleFlags.resize(bounds.chunkRefs.size());
+  CullBounds(frustum, visibleFlags);
+
+  visibleChunks.clear();
+  for (std::size_t i = 0; i < visibleFlags.size(); ++i) {
+    if (visibleFlags[i]) {
+      visibleChunks.push_back(bounds.chunkRefs[i]);
+    }
+  }
+
+  cullingStats.tested = static_cast<int>(bounds.chunkRefs.size());
+  cullingStats.visible = static_cast<int>(visibleChunks.size());
+  cullingStats.microseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+  return visibleChunks;
+}
+
+CullingStats GetCullingStats() { return cullingStats; }
@@ -3,8 +3,10 @@
 #include "db_perlin.hpp"
 #endif // !DEBUG
 
+#include "../core/profiler.h"
 #include "game.h"
 #include "raymath.h"
+#include "rlgl.h"
 #include <algorithm>
 #include <cmath>
 #include <format>
@@ -15,13 +17,42 @@
 Font font{};
 Camera camera{};
 Shader lightingShader{};
+Shader terrainShader{};      // Terrain arena, packed vertices
+Shader terrainFloatShader{}; // Terrain arena, float vertices
+Shader vegetationShader{};   // Instanced
+Shader impostorShader{};     // Instanced vegetation impostors
+Shader grassShader{};        // GPU grass blades
+Shader waterShader{};        // Instanced water patches
 GameState state = GameState::MENU;
 float mouseSensitivity = 0.003f;
 float cameraYaw = 0.0f;
 float cameraPitch = 0.0f;
-int renderDistance = 3;
 
-std::unordered_map<std::pair<int, int>, Chunk, pair_hash> chunks;
+ChunkMap chunks;
+
+static TerrainDrawStats terrainStats; // Submitted last frame
+
+Shader LoadLightingShader(const char *defines, const char *vertexPath) {
+  char *vertexText = LoadFileText(vertexPath);
+  char *fragmentText = LoadFileText("src/shaders/fragment.glsl");
+  if (vertexText == nullptr || fragmentText == nullptr) {
+    UnloadFileText(vertexText);
+    UnloadFileText(fragmentText);
+    return {};
+  }
+
+  const auto withDefines = [defines](std::string source) {
+    const std::size_t version = source.find("#version");
+    const std::size_t lineEnd = source.find('\n', version);
+    source.insert(lineEnd == std::string::npos ? source.size() : lineEnd + 1, defines);
+    return source;
+  };
+  const Shader shader = LoadShaderFromMemory(withDefines(vertexText).c_str(),
+                                             withDefines(fragmentText).c_str());
+  UnloadFileText(vertexText);
+  UnloadFileText(fragmentText);
+  return shader;
+}
 
 void InitGame() {
   std::cout << "Game Initialized" << std::endl;
@@ -37,8 +68,41 @@ void InitGame() {
     std::cout << "Shader loaded successfully!" << std::endl;
   }
 
-  GenerateStars();
+  terrainFloatShader = LoadTerrainShader(false);
+  if (terrainFloatShader.id == 0) {
+    std::cout << "ERROR: Terrain shader failed to load!" << std::endl;
+  }
+
+  terrainShader = LoadTerrainShader(true);
+  if (terrainShader.id == 0) {
+    std::cout << "ERROR: Packed terrain shader failed to load, using float vertices"
+              << std::endl;
+    packedTerrainVertices = false;
+  }
+
+  vegetationShader = LoadVegetationShader();
+  if (vegetationShader.id == 0) {
+    std::cout << "ERROR: Vegetation shader failed to load!" << std::endl;
+  }
+
+  impostorShader = LoadImpostorShader();
+  if (impostorShader.id == 0) {
+    std::cout << "ERROR: Impostor shader failed to load!" << std::endl;
+  }
+
+  grassShader = LoadLightingShader("", "src/shaders/grass.vs");
+  if (grassShader.id == 0) {
+    std::cout << "ERROR: Grass shader failed to load!" << std::endl;
+  }
+
+  waterShader = LoadWaterShader();
+  if (waterShader.id == 0) {
+    std::cout << "ERROR: Water shader failed to load!" << std::endl;
+  }
+
+  InitSky();
   LoadVegetationModels();
+  InitGrass();
   InitWater();
 
   Vector3 lightDir = {-0.9659f, -0.2588f, 0.0f}; // ~15 degrees from horizontal
@@ -50,19 +114,30 @@ void InitGame() {
   lightDir.z /= len;
 
   Vector3 lightColor = {1.1f, 0.9f, 1.1f};
+  const Vector3 fogColor = {skyColorHorizon.r / 255.0f, skyColorHorizon.g / 255.0f,
+                            skyColorHorizon.b / 255.0f};
+
+  for (const Shader &shader :
+       {lightingShader, terrainShader, terrainFloatShader, vegetationShader,
+        impostorShader, grassShader, waterShader}) {
+    SetShaderValue(shader, GetShaderLocation(shader, "lightDir"), &lightDir,
+                   SHADER_UNIFORM_VEC3);
+    SetShaderValue(shader, GetShaderLocation(shader, "lightColor"), &lightColor,
+                   SHADER_UNIFORM_VEC3);
+
+    // Set world boundary uniforms
+    SetShaderValue(shader, GetShaderLocation(shader, "worldCenter"),
+                   &WORLD_CENTER, SHADER_UNIFORM_VEC3);
+    SetShaderValue(shader, GetShaderLocation(shader, "worldRadius"),
+                   &WORLD_RADIUS, SHADER_UNIFORM_FLOAT);
+
+    SetShaderValue(shader, GetShaderLocation(shader, "fogColor"), &fogColor,
+                   SHADER_UNIFORM_VEC3);
+  }
 
-  SetShaderValue(lightingShader, GetShaderLocation(lightingShader, "lightDir"),
-                 &lightDir, SHADER_UNIFORM_VEC3);
-  SetShaderValue(lightingShader,
-                 GetShaderLocation(lightingShader, "lightColor"), &lightColor,
-                 SHADER_UNIFORM_VEC3);
-  
-  // Set world boundary uniforms
-  SetShaderValue(lightingShader, GetShaderLocation(lightingShader, "worldCenter"),
-                 &WORLD_CENTER, SHADER_UNIFORM_VEC3);
-  SetShaderValue(lightingShader, GetShaderLocation(lightingShader, "worldRadius"),
-                 &WORLD_RADIUS, SHADER_UNIFORM_FLOAT);
-  
+  // Spawn placement samples the heightfield, so it has to exist first
+  OpenBakedWorld(worldBakeDirectory);
+  BuildWorldHeightfield();
   initializeSpawnHut();
 
   camera.position = {spawnHut.position.x - 15.0f, spawnHut.position.y + 10.0f,
@@ -72,15 +147,15 @@ void InitGame() {
   camera.fovy = 45.0f;
   camera.projection = CAMERA_PERSPECTIVE;
 
-  for (int dx = -renderDistance; dx <= renderDistance; dx++) {
-    for (int dz = -renderDistance; dz <= renderDistance; dz++) {
-      generateChunk(dx, dz);
-      GenerateVegetationForChunk(chunks[{dx, dz}]);
-    }
-  }
+  InitTerrainBuffers();
+  InitChunkWorkers();
+
+  UpdateChunkStreaming(camera, cameraYaw, GetFogChunkRadius());
+  WaitForChunkRequests();
 }
 
 void UpdateGame() {
+  const ProfileScope scope("UpdateGame");
   if (state == GameState::MENU) {
     const int screenWidth = GetScreenWidth();
     const int screenHeight = GetScreenHeight();
@@ -133,54 +208,89 @@ void UpdateGame() {
                          spawnHut.position.z - 15.0f};
     }
 
-    // Render distance
-    if (IsKeyPressed(KEY_KP_ADD) || IsKeyPressed(KEY_EQUAL)) {
-      renderDistance = std::min(renderDistance + 1, 10);
+    // View distance: the fog, and with it how far chunks stream, a chunk
+    // (2 to 10) at a time
+    constexpr float fogStep = 31.0f;
+    if ((IsKeyPressed(KEY_KP_ADD) || IsKeyPressed(KEY_EQUAL)) && fog.end < 10 * fogStep) {
+      fog.start += fogStep;
+      fog.end += fogStep;
+    }
+    if ((IsKeyPressed(KEY_KP_SUBTRACT) || IsKeyPressed(KEY_MINUS)) && fog.end > 2 * fogStep) {
+      fog.start -= fogStep;
+      fog.end -= fogStep;
+    }
+
+    // Toggle multi-resolution terrain noise and regenerate the world with it
+    if (IsKeyPressed(KEY_M)) {
+      ShutdownChunkWorkers();
+      multiResTerrainNoise = !multiResTerrainNoise;
+      RefreshBakedWorldHash();
+      BuildWorldHeightfield();
+      InitChunkWorkers();
+
+      chunks.forEach(unloadChunk);
+      chunks.clear();
+      ResetChunkStreaming();
     }
-    if (IsKeyPressed(KEY_KP_SUBTRACT) || IsKeyPressed(KEY_MINUS)) {
-      renderDistance = std::max(renderDistance - 1, 2);
+
+    if (IsKeyPressed(KEY_L)) {
+      adaptiveTerrainLod = !adaptiveTerrainLod;
+    }
+
+    if (IsKeyPressed(KEY_O)) {
+      horizonOcclusion = !horizonOcclusion;
     }
 
-    SetShaderValue(lightingShader, GetShaderLocation(lightingShader, "viewPos"),
-                   &camera.position, SHADER_UNIFORM_VEC3);
+    if (IsKeyPressed(KEY_B)) {
+      batchedTerrainDraws = !batchedTerrainDraws;
+    }
 
-    // Chunk loading
-    constexpr int stride = 31;
-    const int cx = static_cast<int>(std::floor(camera.position.x / stride));
-    const int cz = static_cast<int>(std::floor(camera.position.z / stride));
+    if (IsKeyPressed(KEY_F3)) {
+      profilerOverlay = !profilerOverlay;
+    }
+    if (IsKeyPressed(KEY_F4)) {
+      ExportProfilerTrace("profile_trace.json");
+    }
 
-    for (int dx = -renderDistance; dx <= renderDistance; ++dx) {
-      for (int dz = -renderDistance; dz <= renderDistance; ++dz) {
-        const int ncx = cx + dx;
-        const int ncz = cz + dz;
+    if (IsKeyPressed(KEY_F)) {
+      frontToBack = !frontToBack;
+    }
 
-        if (!chunks.contains({ncx, ncz})) {
-          generateChunk(ncx, ncz);
-          GenerateVegetationForChunk(chunks[{ncx, ncz}]);
-        }
-      }
+    if (IsKeyPressed(KEY_V)) {
+      overdrawView = !overdrawView;
     }
 
-    // Unload distant chunks
-    const float unloadDistance =
-        static_cast<float>((renderDistance + 2) * stride);
-    std::vector<std::pair<int, int>> toUnload;
+    if (IsKeyPressed(KEY_I)) {
+      vegetationImpostors = !vegetationImpostors;
+    }
 
-    for (const auto &[coords, chunk] : chunks) {
-      const Vector3 chunkCenter = {
-          static_cast<float>(chunk.x * stride + stride / 2), 15.0f,
-          static_cast<float>(chunk.z * stride + stride / 2)};
-      const float dist = Vector3Distance(camera.position, chunkCenter);
+    if (IsKeyPressed(KEY_G)) {
+      gpuGrass = !gpuGrass;
+    }
 
-      if (dist > unloadDistance) {
-        toUnload.emplace_back(coords.first, coords.second);
-      }
+    // Switch terrain vertex layout; chunks re-upload as they stream back in
+    if (IsKeyPressed(KEY_P) && terrainShader.id != 0) {
+      packedTerrainVertices = !packedTerrainVertices;
+      chunks.forEach(unloadChunk);
+      chunks.clear();
+      ResetChunkStreaming();
     }
 
-    for (const auto &key : toUnload) {
-      UnloadModel(chunks[key].model);
-      chunks.erase(key);
+    const Vector2 fogRange = {fog.start, fog.end};
+    const int overdraw = overdrawView ? 1 : 0;
+    for (const Shader &shader :
+         {lightingShader, terrainShader, terrainFloatShader, vegetationShader,
+          impostorShader, grassShader, waterShader}) {
+      SetShaderValue(shader, GetShaderLocation(shader, "viewPos"),
+                     &camera.position, SHADER_UNIFORM_VEC3);
+      SetShaderValue(shader, GetShaderLocation(shader, "fogRange"), &fogRange,
+                     SHADER_UNIFORM_VEC2);
+      SetShaderValue(shader, GetShaderLocation(shader, "overdrawView"), &overdraw,
+                     SHADER_UNIFORM_INT);
     }
+
+    UpdateTerrainArena();
+    UpdateChunkStreaming(camera, cameraYaw, GetFogChunkRadius());
   } else if (state == GameState::SETTINGS) {
     if (IsKeyPressed(KEY_ESCAPE)) {
       state = GameState::MENU;
@@ -196,6 +306,7 @@ void UpdateGame() {
 }
 
 void DrawGame() {
+  const ProfileScope scope("DrawGame");
   if (state == GameState::MENU) {
     const int screenWidth = GetScreenWidth();
     const int screenHeight = GetScreenHeight();
@@ -237,36 +348,58 @@ void DrawGame() {
                40, 1.0f, WHITE);
 
   } else if (state == GameState::GAME) {
-    ClearBackground(Color{15, 15, 20, 255});
+    ClearBackground(overdrawView ? BLACK : Color{15, 15, 20, 255});
 
+    const float aspect = static_cast<float>(GetScreenWidth()) /
+                         static_cast<float>(GetScreenHeight());
     BeginMode3D(camera);
-
-    DrawSky(camera);
-
-    [[maybe_unused]] int culled = 0;
-    [[maybe_unused]] int rendered = 0;
-
-    for (auto &[coords, chunk] : chunks) {
-      if (!IsChunkInFrustum(chunk, camera)) {
-        ++culled;
-        continue;
-      }
-
-      const Vector3 chunkPos = {static_cast<float>(chunk.x * 31), 0.0f,
-                                static_cast<float>(chunk.z * 31)};
-      DrawModel(chunk.model, chunkPos, 1.0f, WHITE);
-
-      DrawVegetation(chunk, camera);
-
-      ++rendered;
+    // raylib's far plane is fixed at build time; ours is the fog wall
+    rlSetMatrixProjection(GetCameraProjection(camera, aspect));
+
+    // Near to far, so the depth test rejects more of the far terrain
+    static std::vector<const Chunk *> farToNear;
+    std::span<const Chunk *const> visible =
+        OccludeChunks(camera, CullChunks(camera, aspect));
+    // Each chunk batch sorts by where it starts: the nearest chunk it draws
+    // (the nearest water patch for water)
+    const float nearestChunk =
+        visible.empty() ? fog.end : ChunkDistance(*visible.front(), camera.position);
+    const float nearestVegetation = NearestVegetationDistance(visible, camera.position);
+    const float nearestGrass = NearestGrassDistance(visible, camera.position);
+    const float nearestWater = NearestWaterDistance(visible, camera.position);
+    if (!frontToBack) {
+      farToNear.assign(visible.rbegin(), visible.rend());
+      visible = farToNear;
     }
 
-    DrawModel(hutModel, spawnHut.position, 1.0f, WHITE);
+    const Shader &terrain = packedTerrainVertices ? terrainShader : terrainFloatShader;
+    SubmitRenderItem(RenderPass::Opaque, nearestChunk, terrain.id, 0, "draw terrain",
+                     [visible, &terrain] {
+                       terrainStats = DrawTerrainChunks(visible, camera, terrain);
+                     });
+    SubmitRenderItem(RenderPass::Opaque, nearestVegetation, vegetationShader.id, 0,
+                     "draw vegetation",
+                     [visible] { DrawVegetation(visible, camera); });
+    SubmitRenderItem(RenderPass::Opaque, nearestGrass, grassShader.id, 0, "draw grass",
+                     [visible] { DrawGrass(visible, camera); });
+    const float hutDistance = Vector3Distance(camera.position, spawnHut.position);
+    SubmitRenderItem(RenderPass::Opaque, hutDistance, lightingShader.id, 0, "draw hut",
+                     [] { DrawModel(hutModel, spawnHut.position, 1.0f, WHITE); });
+    SubmitRenderItem(RenderPass::Sky, fog.end, 0, 0, "draw sky", [] { DrawSky(); });
+    SubmitRenderItem(RenderPass::Transparent, nearestWater, waterShader.id, 0, "draw water",
+                     [visible] { DrawWater(visible); });
+    FlushRenderQueue();
     // DrawGrid(100, 10.0f);
     EndMode3D();
 
-    DrawFPSCounter();
-    DrawBoundaryWarning();
+    {
+      const ProfileScope hudScope("HUD");
+      DrawFPSCounter();
+      DrawBoundaryWarning();
+    }
+    if (profilerOverlay) {
+      DrawProfilerOverlay(GetScreenWidth() - 620, 10);
+    }
 
   } else if (state == GameState::SETTINGS) {
     const int screenWidth = GetScreenWidth();
@@ -308,17 +441,28 @@ void DrawGame() {
 void UnloadGame() {
   std::cout << "Game Unloaded" << std::endl;
 
+  ReleaseRenderQueue();
   CleanupSky();
   UnloadVegetationModels();
+  CleanupGrass();
   UnloadWater();
   UnloadHut();
+  ShutdownChunkWorkers();
+  CloseBakedWorld();
+  UnloadWorldHeightfield();
+  UnloadPathField();
 
-  for (auto &[coords, chunk] : chunks) {
-    UnloadModel(chunk.model);
-  }
+  chunks.forEach(unloadChunk);
   chunks.clear();
+  UnloadTerrainBuffers();
 
   UnloadShader(lightingShader);
+  UnloadShader(terrainShader);
+  UnloadShader(terrainFloatShader);
+  UnloadShader(vegetationShader);
+  UnloadShader(impostorShader);
+  UnloadShader(grassShader);
+  UnloadShader(waterShader);
   UnloadFont(font);
 }
 
@@ -341,10 +485,10 @@ void DrawFPSCounter() {
   fpsIndex = (fpsIndex + 1) % fpsHistory.size();
 
   float sum = 0.0f;
-  for (int i = 0; i < 60; ++i) {
-    sum += fpsHistory[i];
+  for (const float fps : fpsHistory) {
+    sum += fps;
   }
-  const float avgFps = sum / 60.0f;
+  const float avgFps = sum / static_cast<float>(fpsHistory.size());
 
   const std::string fpsText = std::format("FPS: {:.0f}", avgFps);
   DrawText(fpsText.c_str(), 10, 10, 20, YELLOW);
@@ -361,4 +505,123 @@ void DrawFPSCounter() {
   const std::string distText =
       std::format("Distance from spawn: {:.1f}", distFromSpawn);
   DrawText(distText.c_str(), 10, 60, 20, YELLOW);
+
+  // The profiler overlay has the rest, and the space they would take
+  if (profilerOverlay) {
+    return;
+  }
+
+  // Chunk streaming queue depth
+  const ChunkQueueStats queue = GetChunkQueueStats();
+  const std::string queueText =
+      std::format("Chunks: {} loaded, {} pending, {} in flight, {} ready",
+                  chunks.count(), queue.pending, queue.inFlight, queue.ready);
+  DrawText(queueText.c_str(), 10, 85, 20, YELLOW);
+
+  const std::string noiseText = std::format(
+      "Terrain noise: {} (M)", multiResTerrainNoise ? "multi-res" : "exact");
+  DrawText(noiseText.c_str(), 10, 110, 20, YELLOW);
+
+  const std::string terrainText = std::format(
+      "Terrain: {} chunks, {} tris ({:.0f}% of full), {} verts, LOD {} (L)",
+      terrainStats.chunks, terrainStats.triangles,
+      terrainStats.fullResTriangles > 0
+          ? 100.0 * terrainStats.triangles / terrainStats.fullResTriangles
+          : 100.0,
+      terrainStats.vertices, adaptiveTerrainLod ? "on" : "off");
+  DrawText(terrainText.c_str(), 10, 135, 20, YELLOW);
+
+  const std::string vramText = std::format(
+      "Terrain VRAM: {:.2f} MB, {} vertices (P)",
+      static_cast<double>(GetTerrainGpuBytes()) / (1024.0 * 1024.0),
+      packedTerrainVertices ? "packed" : "float");
+  DrawText(vramText.c_str(), 10, 160, 20, YELLOW);
+
+  const TerrainArenaStats arena = GetTerrainArenaStats();
+  const std::string arenaText = std::format(
+      "Terrain arena: {}/{}k verts, {}/{}k indices ({} grows, {} shrinks)",
+      arena.usedVertices / 1024, arena.vertexCapacity / 1024, arena.usedIndices / 1024,
+      arena.indexCapacity / 1024, arena.grows, arena.shrinks);
+  DrawText(arenaText.c_str(), 10, 185, 20, YELLOW);
+
+  const std::string poolText = std::format(
+      "Buffer pool: {} live, {} idle, {} retiring ({} created, {} reused)", arena.meshes,
+      arena.idle, arena.retiring, arena.created, arena.reused);
+  DrawText(poolText.c_str(), 10, 210, 20, YELLOW);
+
+  const ChunkStreamingStats streaming = GetChunkStreamingStats();
+  const std::string streamingText = std::format(
+      "Streaming: {:.0f} planned/s, {:.0f} loaded/s, {:.0f} evicted/s ({} replans)",
+      streaming.plannedPerSecond, streaming.loadedPerSecond,
+      streaming.evictedPerSecond, streaming.replans);
+  DrawText(streamingText.c_str(), 10, 235, 20, YELLOW);
+
+  const CullingStats culling = GetCullingStats();
+  const std::string cullingText = std::format(
+      "Culling: {} rendered, {} culled in {:.1f} us", culling.visible,
+      culling.tested - culling.visible, culling.microseconds);
+  DrawText(cullingText.c_str(), 10, 260, 20, YELLOW);
+
+  const OcclusionStats occlusion = GetOcclusionStats();
+  const std::string occlusionText = std::format(
+      "Occlusion: {} of {} hidden in {:.1f} us (O), opaque GPU {:.2f} ms",
+      occlusion.occluded, occlusion.tested, occlusion.microseconds,
+      GetRenderQueueStats().gpuMilliseconds[0]);
+  DrawText(occlusionText.c_str(), 10, 285, 20, YELLOW);
+
+  const std::string submitText = std::format(
+      "Terrain submit: {} draw calls, {:.0f} us CPU, {} (B)",
+      terrainStats.drawCalls, terrainStats.submitMicroseconds,
+      batchedTerrainDraws ? "multi-draw" : "per chunk");
+  DrawText(submitText.c_str(), 10, 310, 20, YELLOW);
+
+  const SkyStats sky = GetSkyStats();
+  const std::string skyText = std::format("Sky: {} draw calls, {:.1f} us CPU",
+                                          sky.drawCalls, sky.microseconds);
+  DrawText(skyText.c_str(), 10, 335, 20, YELLOW);
+
+  const VegetationStats vegetation = GetVegetationStats();
+  const auto &counts = vegetation.instances;
+  const std::string vegetationText = std::format(
+      "Vegetation: {} trees, {} stumps, {} grass, {} ferns; {} draw calls, {:.0f} us CPU",
+      counts[1] + counts[2] + counts[4], counts[0], counts[3], counts[5],
+      vegetation.drawCalls, vegetation.microseconds);
+  DrawText(vegetationText.c_str(), 10, 360, 20, YELLOW);
+
+  const std::string impostorText = std::format(
+      "Impostors: {} drawn ({}, I to toggle); {}k tris vs {}k as geometry, atlases {:.1f} MB",
+      vegetation.impostors, vegetationImpostors ? "on" : "off",
+      vegetation.triangles / 1000, vegetation.geometryTriangles / 1000,
+      static_cast<float>(vegetation.impostorBytes) / (1024.0f * 1024.0f));
+  DrawText(impostorText.c_str(), 10, 385, 20, YELLOW);
+
+  const GrassStats grass = GetGrassStats();
+  const std::string grassText = std::format(
+      "Grass: {}k blades in {} chunks ({}, G to toggle); {} draw calls, {:.0f} us CPU",
+      grass.blades / 1000, grass.chunks, gpuGrass ? "GPU" : "models", grass.drawCalls,
+      grass.microseconds);
+  DrawText(grassText.c_str(), 10, 410, 20, YELLOW);
+
+  const WaterStats water = GetWaterStats();
+  const std::string waterText =
+      std::format("Water: {} patches in {} chunks; {} draw calls, {:.0f} us CPU",
+                  water.patches, water.chunks, water.drawCalls, water.microseconds);
+  DrawText(waterText.c_str(), 10, 435, 20, YELLOW);
+
+  const std::string fogText =
+      std::format("Fog: {:.0f} to {:.0f} (+/- to change); far plane {:.0f}, streaming {} chunks",
+                  fog.start, fog.end, fog.end, GetFogChunkRadius());
+  DrawText(fogText.c_str(), 10, 460, 20, YELLOW);
+
+  const RenderQueueStats queueStats = GetRenderQueueStats();
+  std::string renderText = std::format(
+      "Render queue: {} items sorted in {:.1f} us, {} (F); GPU {:.2f} opaque + {:.2f} sky + "
+      "{:.2f} transparent ms",
+      queueStats.items, queueStats.sortMicroseconds,
+      frontToBack ? "front to back" : "back to front", queueStats.gpuMilliseconds[0],
+      queueStats.gpuMilliseconds[1], queueStats.gpuMilliseconds[2]);
+  if (overdrawView) {
+    renderText += std::format(", overdraw {:.2f}x (V)", queueStats.overdraw);
+  }
+  DrawText(renderText.c_str(), 10, 485, 20, YELLOW);
 }
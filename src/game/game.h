@@ -1,5 +1,6 @@
 #pragma once
 
+#include "chunkGrid.h"
 #include "raylib.h"
 #include "raymath.h"
 #include <unordered_map>
@@ -7,6 +8,10 @@
 #include <array>
 #include <span>
 #include <memory>
+#include <functional>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
 
 enum class GameState { MENU, GAME, SETTINGS };
 
@@ -26,21 +31,64 @@ struct VegetationInstance {
   Vector3 position;
   float rotation;
   float scale;
-  int modelType; // 0=stump, 1=oak, 2=lowpoly, 3=grass
+  int modelType; // 0=stump, 1=oak, 2=lowpoly, 3=grass, 4=conifer, 5=fern
 };
+inline constexpr int vegetationModelCount = 6;
+inline constexpr float waterLevel = 10.0f;
+
+// Where an uploaded terrain mesh lives in the terrain arena (terrainMesh.cpp)
+struct TerrainMeshRange {
+  int baseVertex; // Page aligned
+  int vertexCount;
+  int firstIndex;
+  int indexCount;
+  bool ownIndices; // False for full grids, which share the grid's indices
+};
+
+// Horizon occluder resolution: cells of 4x4 grid quads (the last row and
+// column 3), 8 per side
+inline constexpr int occluderCellQuads = 4;
+inline constexpr int occluderCells = 8;
 
 struct Chunk {
   int x, z;
-  Model model;
   std::vector<float> heights;
   std::vector<float> moisture;
   std::vector<VegetationInstance> vegetation;
+  // vegetation's transforms grouped by modelType, for instanced drawing
+  std::array<std::vector<Matrix>, vegetationModelCount> vegetationTransforms;
+  // Adaptive LODs 1..N of the terrain mesh, CPU side until uploaded
+  std::vector<Mesh> lodMeshes;
+  // Once uploaded: [0] the full grid, [i] LOD i
+  std::vector<TerrainMeshRange> meshRanges;
+  float minHeight, maxHeight; // World-space mesh height range
+  float contentTop = 0.0f;    // World-space top of the terrain and its vegetation
+  // Lowest any LOD of the mesh gets in each occluder cell, row-major
+  std::array<float, occluderCells * occluderCells> occluderHeights;
+  unsigned int grassTexture = 0; // The chunk's grass field, once uploaded
+  // Its submerged cells as stretched unit quads; empty where there is no water
+  std::vector<Matrix> waterPatches;
+};
+
+// Loaded chunks, 32x32 slots around the camera (see chunkGrid.h)
+using ChunkMap = ChunkGrid<Chunk, 32>;
+extern ChunkMap chunks;
+
+// CPU-side result of chunk generation. Built on a worker thread, then
+// finished on the main thread by uploadChunk().
+struct ChunkBuild {
+  Chunk chunk;
+  Mesh mesh;
+  std::vector<float> grassField; // BuildGrassField(), until uploaded
 };
 
 struct pair_hash {
   template <class T1, class T2>
   [[nodiscard]] constexpr std::size_t operator()(const std::pair<T1, T2> &pair) const noexcept {
-    return std::hash<T1>()(pair.first) ^ (std::hash<T2>()(pair.second) << 1);
+    // Plain x ^ (z << 1) sends (2, 1) and (0, 0) to the same bucket
+    const std::size_t h1 = std::hash<T1>()(pair.first);
+    const std::size_t h2 = std::hash<T2>()(pair.second);
+    return h1 ^ (h2 + 0x9e3779b97f4a7c15ull + (h1 << 6) + (h1 >> 2));
   }
 };
 
@@ -48,35 +96,425 @@ void InitGame();
 void UpdateGame();
 void DrawGame();
 void UnloadGame();
+// vertex.glsl (or another vertex shader) and fragment.glsl, with defines
+// (e.g. "#define X\n") inserted after their #version lines
+[[nodiscard]] Shader LoadLightingShader(const char *defines,
+                                        const char *vertexPath = "src/shaders/vertex.glsl");
 void generateChunk(int cx, int cz);
-float getTerrainHeight(float wx, float wz);
-[[nodiscard]] bool IsChunkInFrustum(const Chunk &chunk, const Camera &camera) noexcept;
+[[nodiscard]] ChunkBuild buildChunk(int cx, int cz);
+void uploadChunk(ChunkBuild &&build);
+void discardChunkBuild(ChunkBuild &build);
+void unloadChunk(Chunk &chunk);
+// Raw (unsmoothed) terrain heights for a 32x32 chunk, row-major
+[[nodiscard]] std::vector<float> sampleTerrainHeights(int cx, int cz, bool multiRes);
+// buildChunk()'s smoothing pass, in place; border vertices are left as is
+void smoothTerrainHeights(std::vector<float> &heights);
+// World-space mesh height at any point, matching the chunk meshes
+[[nodiscard]] float getTerrainHeight(float wx, float wz);
+
+// Distance fog: fragments fade into the sky's horizon colour between start
+// and end. Nothing past end can be seen, so end is also the far plane and
+// bounds culling, vegetation and the streaming radius.
+struct Fog {
+  float start;
+  float end; // Fully opaque
+};
+
+inline Fog fog = {45.0f, 93.0f}; // +/- move it a chunk at a time
+inline constexpr Color skyColorHorizon = {115, 102, 97, 255}; // Also the fog colour
+
+// View frustum culling (frustumCulling.cpp)
+struct Frustum {
+  std::array<Vector4, 6> planes; // left, right, bottom, top, near, far
+};
+
+struct CullingStats {
+  int tested;
+  int visible;
+  float microseconds; // Whole pass: extraction, gather, test, compaction
+};
+
+// The perspective projection drawing uses, with its far plane at fog.end
+[[nodiscard]] Matrix GetCameraProjection(const Camera &camera, float aspect) noexcept;
+[[nodiscard]] Frustum ExtractFrustum(const Camera &camera, float aspect) noexcept;
+// Loaded chunks whose bounds touch the view frustum and come closer than
+// fog.end, nearest first. Valid until the next call.
+[[nodiscard]] std::span<const Chunk *const> CullChunks(const Camera &camera, float aspect);
+[[nodiscard]] CullingStats GetCullingStats();
+// From eye to the nearest point of the chunk's bounds; 0 inside them
+[[nodiscard]] float ChunkDistance(const Chunk &chunk, Vector3 eye) noexcept;
+
+// Terrain horizon occlusion (horizonOcclusion.cpp)
+struct OcclusionStats {
+  int tested;
+  int occluded;
+  float microseconds;
+};
+
+inline bool horizonOcclusion = true; // Toggle with O
+
+// The chunks not hidden behind nearer terrain, nearest first. Occluders are
+// the candidates themselves. Valid until the next call.
+[[nodiscard]] std::span<const Chunk *const>
+OccludeChunks(const Camera &camera, std::span<const Chunk *const> candidates);
+[[nodiscard]] OcclusionStats GetOcclusionStats();
+void computeOccluderHeights(Chunk &chunk); // From chunk.heights
 
 void UpdatePlayer(float deltaTime);
 void initializeSpawnHut();
-float getTerrainHeight(float worldX, float worldZ);
 void UnloadHut();
 
-void GenerateStars();
-void DrawSky(Camera camera);
+struct SkyStats {
+  int drawCalls = 0;
+  float microseconds = 0.0f; // CPU
+};
+
+void InitSky();
+void DrawSky(); // After the opaque pass, depth tested at the far plane
+[[nodiscard]] SkyStats GetSkyStats();
 void CleanupSky();
 
+// Vegetation (vegetation.cpp). Each model type is drawn with one
+// DrawMeshInstanced per mesh and LOD, over every visible chunk at once.
+struct VegetationStats {
+  std::array<int, vegetationModelCount> instances; // Drawn, per modelType
+  int impostors;                // Instances drawn as impostors (also in instances)
+  std::int64_t triangles;       // Drawn, impostor quads included
+  std::int64_t geometryTriangles; // The same instances without impostors
+  std::size_t impostorBytes;    // Atlas memory
+  int drawCalls;
+  float microseconds; // CPU, gather and submit
+};
+
+// Octahedral impostors (impostors.cpp): a model baked from a hemisphere of
+// views into albedo and normal-depth atlases, drawn far away as one
+// camera-facing quad per instance
+struct VegetationImpostor {
+  RenderTexture2D albedo;      // Coverage in alpha
+  RenderTexture2D normalDepth; // Normal in rgb, depth in alpha
+  Material material;           // The atlases as its albedo and normal maps
+  float radius;                // Bounding sphere at scale 1
+  float centreY;               // Its centre above the model origin
+};
+
+[[nodiscard]] Shader LoadImpostorShader();
+// Needs a GL context; the model is baked with fit applied
+[[nodiscard]] VegetationImpostor BakeVegetationImpostor(const Model &model, const Matrix &fit);
+[[nodiscard]] std::size_t GetImpostorAtlasBytes(); // Per impostor
+// Instances fade in from geometry over fade (distance from, to)
+void DrawVegetationImpostors(const VegetationImpostor &impostor,
+                             std::span<const Matrix> transforms, Vector2 fade);
+void UnloadVegetationImpostor(VegetationImpostor &impostor);
+void UnloadImpostorQuad();
+
+inline bool vegetationImpostors = true; // Toggle with I
+
 void LoadVegetationModels();
-void GenerateVegetationForChunk(Chunk &chunk);
-void DrawVegetation(const Chunk &chunk, const Camera &camera);
+[[nodiscard]] Shader LoadVegetationShader(); // Instanced lighting shader
+// Also raises chunk.contentTop; pathInfluence is per vertex, like heights
+void GenerateVegetationForChunk(Chunk &chunk, std::span<const float> pathInfluence);
+void DrawVegetation(std::span<const Chunk *const> visible, const Camera &camera);
+// Distance to the nearest chunk DrawVegetation() would draw, or fog.end
+[[nodiscard]] float NearestVegetationDistance(std::span<const Chunk *const> visible, Vector3 eye);
+[[nodiscard]] VegetationStats GetVegetationStats();
 void UnloadVegetationModels();
 
+// GPU grass (grass.cpp): dense blades generated in grass.vs from the
+// instance ID and a small per-chunk texture, one instanced draw per chunk.
+// Replaces the dry grass model while on.
+struct GrassStats {
+  int chunks;
+  std::int64_t blades; // Submitted; the shader drops those on paths and water
+  int drawCalls;
+  float microseconds; // CPU
+};
+
+inline bool gpuGrass = true; // Toggle with G
+
+void InitGrass();
+// Worker side: per vertex world height, path influence and moisture
+[[nodiscard]] std::vector<float> BuildGrassField(const Chunk &chunk,
+                                                 std::span<const float> pathInfluence);
+[[nodiscard]] unsigned int UploadGrassField(std::span<const float> field);
+void UnloadGrassField(unsigned int texture);
+void DrawGrass(std::span<const Chunk *const> visible, const Camera &camera);
+// Distance to the nearest chunk DrawGrass() would draw, or fog.end
+[[nodiscard]] float NearestGrassDistance(std::span<const Chunk *const> visible, Vector3 eye);
+[[nodiscard]] GrassStats GetGrassStats();
+void CleanupGrass();
+
+// Procedural path network. A point is on a path in the primary band
+// (|noise1| + weight2 * |noise2| under threshold) where the ground is flat
+// enough, or in the secondary band.
+struct PathShape {
+  float frequency1, offset1, frequency2, offset2, weight2, threshold;
+  float slopeFrequency, slopeScale, slopeStep, maxSlope;
+  float secondaryFrequency, secondaryOffset, secondaryThreshold;
+  float maxInfluence, neighbourFalloff; // Per off-path neighbour
+};
+inline constexpr PathShape pathShape = {0.015f, 1000.0f, 0.02f, 2000.0f, 0.5f, 0.15f,
+                                        0.008f, 4.0f,    2.0f,  0.8f,
+                                        0.01f,  5000.0f, 0.08f,
+                                        0.7f,   0.55f};
+
+// Path influence field (lazily rasterized, shared by all consumers)
+float getPathInfluence(float wx, float wz);
+float evaluatePathInfluence(float wx, float wz) noexcept;
+// The procedural path bands without the slope test, which only decides
+// where a path is drawn; vegetation keeps off the whole band
+[[nodiscard]] bool isOnPathIgnoringSlope(float wx, float wz) noexcept;
+// The same at the nearest integer position, looked up in the field
+[[nodiscard]] bool isInPathBand(float wx, float wz);
+void AddAuthoredPath(const Path &path);
+[[nodiscard]] std::span<const Path> GetAuthoredPaths();
+[[nodiscard]] int GetPathFieldTileCount();
+void UnloadPathField();
+
+// Adaptive terrain LOD. Level 0 is the full grid; level i > 0 stays within
+// terrainLodLevels[i - 1] of it.
+struct TerrainLodLevel {
+  float maxError;      // Vertical, world units
+  float maxColorError; // Per channel, 0-255
+};
+inline constexpr std::array<TerrainLodLevel, 3> terrainLodLevels = {{
+    {0.01f, 4.0f},
+    {0.05f, 12.0f},
+    {0.25f, 32.0f},
+}};
+inline float terrainLodPixelError = 1.0f; // Allowed screen-space error
+inline bool adaptiveTerrainLod = true;     // Toggle with L
+
+// Full-resolution chunk surface the LODs are cut from (32x32, row-major)
+struct TerrainSurface {
+  std::span<const float> heights;         // World units
+  std::span<const unsigned char> colors; // RGBA
+};
+
+[[nodiscard]] std::vector<unsigned short>
+triangulateTerrain(const TerrainSurface &surface, const TerrainLodLevel &level);
+[[nodiscard]] Mesh buildTerrainLodMesh(const Mesh &full,
+                                       std::span<const unsigned short> indices);
+[[nodiscard]] int selectTerrainLod(const Chunk &chunk, const Camera &camera);
+
+// Per-vertex chunk data before meshing (32x32, row-major). Generated live by
+// generateChunkFields() or viewed straight out of a baked region file.
+struct ChunkFieldsView {
+  std::span<const float> heights;        // Smoothed, before the x5 mesh scale
+  std::span<const float> moisture;
+  std::span<const float> pathInfluence;
+  std::span<const float> normals;        // xyz
+  std::span<const unsigned char> colors; // RGBA
+  std::array<std::span<const unsigned short>, terrainLodLevels.size()> lodIndices;
+};
+
+struct ChunkFields {
+  std::vector<float> heights;
+  std::vector<float> moisture;
+  std::vector<float> pathInfluence;
+  std::vector<float> normals;
+  std::vector<unsigned char> colors;
+  std::array<std::vector<unsigned short>, terrainLodLevels.size()> lodIndices;
+
+  [[nodiscard]] ChunkFieldsView view() const {
+    ChunkFieldsView v{heights, moisture, pathInfluence, normals, colors, {}};
+    for (std::size_t i = 0; i < lodIndices.size(); ++i) {
+      v.lodIndices[i] = lodIndices[i];
+    }
+    return v;
+  }
+};
+
+[[nodiscard]] ChunkFields generateChunkFields(int cx, int cz);
+// Changes whenever generateChunkFields() would produce different output
+[[nodiscard]] std::uint64_t TerrainGeneratorHash();
+
+// World heightfield: smoothed heights for every chunk the player can reach,
+// built in parallel at startup. One chunk-shaped 32x32 tile per chunk (edge
+// vertices duplicated, as in the meshes), tiles stored row-major, so a height
+// query touches one 4 KB tile and needs no chunk lookup.
+void BuildWorldHeightfield(); // Again whenever the terrain generator changes
+void UnloadWorldHeightfield();
+[[nodiscard]] std::span<const float> GetWorldHeightTile(int cx, int cz); // Empty outside
+
+// Baked world: the bounded world's chunk fields written ahead of time as
+// region files (raven --bake-world), memory-mapped at runtime. Chunks outside
+// the bake, or in a region baked by a different generator, are built live.
+inline constexpr const char *worldBakeDirectory = "baked";
+inline constexpr int worldRegionChunks = 8; // Per axis
+
+bool BakeWorld(const std::filesystem::path &directory);
+bool BakeWorldRegion(const std::filesystem::path &directory, int rx, int rz);
+void OpenBakedWorld(const std::filesystem::path &directory);
+void CloseBakedWorld();
+// Main thread, with the chunk workers stopped, after anything that changes
+// TerrainGeneratorHash() (multi-res noise, authored paths); opening does it
+void RefreshBakedWorldHash();
+// Safe to call from chunk workers while the baked world is open
+[[nodiscard]] std::optional<ChunkFieldsView> FindBakedChunk(int cx, int cz);
+
+// Compact terrain vertex: 8 bytes instead of 28 (colour stays separate).
+// Height is unorm16 over [terrainHeightMin, terrainHeightMin + range), x/z
+// are grid coordinates and the normal is octahedral-encoded around +Y.
+struct PackedTerrainVertex {
+  std::uint16_t height;
+  std::uint8_t x, z;
+  std::array<std::uint16_t, 2> normal;
+};
+static_assert(sizeof(PackedTerrainVertex) == 8);
+
+inline constexpr float terrainHeightMin = -128.0f;
+inline constexpr float terrainHeightRange = 256.0f; // 4mm steps
+inline bool packedTerrainVertices = true;            // Toggle with P
+
+[[nodiscard]] PackedTerrainVertex PackTerrainVertex(int x, int z, float height,
+                                                    Vector3 normal) noexcept;
+// vertex.glsl's terrain arena variant, packed or float vertices
+[[nodiscard]] Shader LoadTerrainShader(bool packed);
+
+// Terrain arena: every uploaded terrain mesh in one set of buffers
+void InitTerrainBuffers();
+void UnloadTerrainBuffers();
+[[nodiscard]] std::vector<unsigned short> BuildTerrainGridIndices(); // Row-major
+[[nodiscard]] std::span<const unsigned short> GetTerrainGridIndices(); // Cache-optimised
+[[nodiscard]] std::span<const float> GetTerrainGridTexcoords();
+// Copies the mesh in for chunk (cx, cz); the CPU arrays can go afterwards
+[[nodiscard]] TerrainMeshRange UploadTerrainMesh(const Mesh &mesh, int cx, int cz);    // Full grid
+[[nodiscard]] TerrainMeshRange UploadTerrainLodMesh(const Mesh &mesh, int cx, int cz); // Own indices
+void ReleaseTerrainMesh(const TerrainMeshRange &range);
+void UpdateTerrainArena(); // Once per frame
+[[nodiscard]] std::size_t GetTerrainGpuBytes();
+
+struct TerrainArenaStats {
+  int meshes;   // Live
+  int idle;     // Free space, in full-grid meshes
+  int retiring; // Released, waiting on the GPU
+  int created;  // Uploads into never-used space
+  int reused;   // Uploads into space a released mesh had
+  int usedVertices;
+  int vertexCapacity;
+  int usedIndices;
+  int indexCapacity;
+  int grows;
+  int shrinks;
+};
+
+// Idle full-grid meshes' worth of space kept before the arena shrinks
+inline int terrainPoolHighWater = 256;
+
+[[nodiscard]] TerrainArenaStats GetTerrainArenaStats();
+
+// Terrain geometry submitted in a frame
+struct TerrainDrawStats {
+  int chunks;
+  int triangles;
+  int vertices;
+  int fullResTriangles; // What the same chunks cost at LOD 0
+  int drawCalls;
+  float submitMicroseconds; // LOD selection and draw submission, CPU side
+};
+
+inline bool batchedTerrainDraws = true; // One multi-draw, else one per chunk (B)
+// Draws the chunks' terrain, each at its selected LOD, in one shader binding
+TerrainDrawStats DrawTerrainChunks(std::span<const Chunk *const> visible,
+                                   const Camera &camera, const Shader &shader);
+void OptimizeVertexCache(std::span<unsigned short> indices, int vertexCount);
+[[nodiscard]] float ComputeACMR(std::span<const unsigned short> indices, int cacheSize);
+
+// Water (water.cpp): only chunks with terrain below waterLevel have any,
+// drawn after the opaque passes as one instanced, blended draw
+struct WaterStats {
+  int chunks;
+  int patches; // Merged rectangles of submerged cells
+  int drawCalls;
+  float microseconds; // CPU
+};
+
+[[nodiscard]] Shader LoadWaterShader(); // Instanced lighting shader
 void InitWater();
-void DrawWater(const Camera &camera);
+// Worker side: rectangles covering the cells with a corner under water
+[[nodiscard]] std::vector<Matrix> BuildWaterPatches(const Chunk &chunk);
+void DrawWater(std::span<const Chunk *const> visible);
+// Distance to the nearest visible patch, or fog.end
+[[nodiscard]] float NearestWaterDistance(std::span<const Chunk *const> visible, Vector3 eye);
+[[nodiscard]] WaterStats GetWaterStats();
 void UnloadWater();
 
+// Render queue (renderQueue.cpp): the 3D pass's draws, submitted as items
+// and run sorted by pass, depth and state: opaque front to back, the sky,
+// then transparent back to front
+enum class RenderPass : std::uint8_t { Opaque, Sky, Transparent };
+
+struct RenderQueueStats {
+  int items;
+  float sortMicroseconds;
+  std::array<float, 3> gpuMilliseconds; // Per RenderPass
+  float overdraw; // Shaded fragments per pixel, in the overdraw view
+};
+
+inline bool frontToBack = true;   // Else back to front, sky first (F)
+inline bool overdrawView = false; // Shaded fragments as brightness (V)
+
+// depth: world distance to the item's nearest part
+// name: a string literal, for the profiler
+void SubmitRenderItem(RenderPass pass, float depth, unsigned int shader, unsigned int material,
+                      const char *name, std::function<void()> draw);
+void FlushRenderQueue();
+[[nodiscard]] RenderQueueStats GetRenderQueueStats();
+void ReleaseRenderQueue(); // Before the GL context goes away
+
 void DrawFPSCounter();
 
+// Background chunk generation
+struct ChunkQueueStats {
+  int pending;  // Queued, not picked up by a worker yet
+  int inFlight; // Being built on a worker
+  int ready;    // Built, waiting for GPU upload
+};
+
+void InitChunkWorkers();
+void ShutdownChunkWorkers();
+// Lower priority values are built first. False if already requested.
+bool RequestChunk(int cx, int cz, float priority = 0.0f);
+void PrioritizeChunkRequests(const std::function<float(int, int)> &priority);
+void CancelChunkRequests(const std::function<bool(int, int)> &shouldCancel);
+// Returns how many chunks were uploaded. Builds that went out of range
+// while in flight are dropped, as is any that would displace a chunk still
+// in range.
+int UploadReadyChunks(const std::function<bool(int, int)> &isOutOfRange);
+void WaitForChunkRequests();
+[[nodiscard]] ChunkQueueStats GetChunkQueueStats();
+
+// Chunk streaming around the camera; replans only on chunk changes
+struct ChunkStreamingStats {
+  float plannedPerSecond; // Newly requested
+  float loadedPerSecond;  // Uploaded
+  float evictedPerSecond; // Unloaded for being out of range
+  int replans;
+};
+
+inline int chunkUnloadHysteresis = 2; // Chunks past the render distance kept
+void UpdateChunkStreaming(const Camera &camera, float yaw, int renderDistance);
+void ResetChunkStreaming(); // Replan on the next update
+// Chunks around the camera's that can come closer than fog.end
+[[nodiscard]] int GetFogChunkRadius() noexcept;
+[[nodiscard]] ChunkStreamingStats GetChunkStreamingStats();
+
+// Per-frame GPU upload budget, whichever limit is hit first
+inline int chunkUploadsPerFrame = 4;
+inline int chunkUploadBudgetUs = 2000;
+
+// Evaluate low-frequency terrain octaves on coarse lattices and upsample
+// (toggle with M). Read by the workers: only change it while they're stopped.
+inline bool multiResTerrainNoise = true;
+
 // World boundaries
 constexpr Vector3 WORLD_CENTER = {0.0f, 0.0f, 0.0f};
 constexpr float WORLD_RADIUS = 750.0f;
 constexpr float SOFT_BOUNDARY_START = 650.0f; // Start gentle push
 constexpr float HARD_BOUNDARY_START = 850.0f; // Strong push back (100 units past radius)
+// Chunk range (both axes, inclusive) covering the hard boundary's square
+constexpr int WORLD_CHUNK_MIN = -static_cast<int>(HARD_BOUNDARY_START) / 31 - 1;
+constexpr int WORLD_CHUNK_MAX = static_cast<int>(HARD_BOUNDARY_START) / 31;
 
 void ApplyWorldBoundaries(float deltaTime);
 void DrawBoundaryWarning();
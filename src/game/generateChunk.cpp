@@ -1,100 +1,265 @@
+#include "../core/profiler.h"
 #include "db_perlin.hpp"
 #include "game.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
 #include <vector>
 
-extern std::unordered_map<std::pair<int, int>, Chunk, pair_hash> chunks;
-extern Shader lightingShader;
+struct TerrainOctave {
+  float frequency;
+  float offset;
+  float amplitude;
+};
+
+// MUCH LARGER scale terrain features - frequencies reduced dramatically
+constexpr std::array<TerrainOctave, 4> terrainOctaves = {{
+    {0.0015f, 0.0f, 8.0f},  // Base terrain - very large rolling hills
+    {0.003f, 100.0f, 4.0f}, // Secondary large features (mountains/plateaus)
+    {0.006f, 200.0f, 1.5f}, // Medium variation (gentle slopes)
+    {0.015f, 300.0f, 0.4f}, // Fine detail (very subtle - barely noticeable)
+}};
+constexpr TerrainOctave valleyOctave = {0.001f, 500.0f, 1.0f}; // Very wide valleys
+
+// Everything else that shapes the generated fields. TerrainGeneratorHash()
+// covers all of it, so baked regions go stale when any of it changes.
+struct ValleyShape {
+  float threshold; // Valley noise below this carves
+  float depth;     // Per unit of noise past the threshold
+  float baseHeight;
+};
+constexpr ValleyShape valleyShape = {-0.25f, 3.0f, 3.0f}; // Gentle broad valleys
+
+struct TerrainSmoothing {
+  int iterations;
+  float centreWeight;
+  float neighbourWeight; // Each of the four
+};
+// Light - the noise is already smooth at this scale
+constexpr TerrainSmoothing terrainSmoothing = {4, 0.5f, 0.125f};
+
+struct MoistureShape {
+  float frequency, offset;
+  float base, noiseScale;
+  float lowlandHeight, lowlandBonus; // Wetter below this height
+};
+constexpr MoistureShape moistureShape = {0.008f, 2000.0f, 0.5f, 0.3f, 2.5f, 0.3f};
+
+// Ground colour by height: base RGB plus moisture times a per-channel scale
+struct TerrainColourBand {
+  float maxHeight;
+  std::array<int, 3> base;
+  std::array<float, 3> moistureScale;
+};
+constexpr std::array<TerrainColourBand, 4> terrainColourBands = {{
+    {1.5f, {45, 50, 35}, {15.0f, 20.0f, 10.0f}},
+    {3.5f, {60, 65, 45}, {15.0f, 20.0f, 0.0f}},
+    {5.0f, {70, 68, 55}, {0.0f, 0.0f, 0.0f}},
+    {std::numeric_limits<float>::max(), {75, 70, 65}, {0.0f, 0.0f, 0.0f}},
+}};
+constexpr std::array<float, 3> pathColour = {80.0f, 75.0f, 60.0f};
+
+// Multi-resolution noise: an octave is sampled every `step` units, where the
+// step is the largest power of two that keeps the noise phase between lattice
+// points under maxLatticePhase. Catmull-Rom upsampling then stays within about
+// 0.01 world units of the exact heights (measured by raven_bench).
+constexpr float maxLatticePhase = 0.05f;
+constexpr int maxLatticeStep = 16;
+constexpr int minLatticeStep = 4; // Finer than this, full resolution is cheaper
+
+[[nodiscard]] static constexpr int latticeStep(float frequency) noexcept {
+  int step = 1;
+  while (step * 2 <= maxLatticeStep &&
+         frequency * static_cast<float>(step * 2) <= maxLatticePhase) {
+    step *= 2;
+  }
+  return step < minLatticeStep ? 1 : step;
+}
 
-[[nodiscard]] bool isOnPath(float wx, float wz) noexcept {
-  const float pathNoise1 = db::perlin(wx * 0.015f + 1000.0f, wz * 0.015f + 1000.0f);
-  const float pathNoise2 = db::perlin(wx * 0.02f + 2000.0f, wz * 0.02f + 2000.0f);
+[[nodiscard]] static constexpr int floorDiv(int a, int b) noexcept {
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
 
-  const float pathValue = std::abs(pathNoise1) + std::abs(pathNoise2) * 0.5f;
+// Adds sum(amplitude * noise) over `octaves` to a chunk-sized grid. With
+// step > 1 the noise is sampled on a world-aligned lattice and upsampled with
+// Catmull-Rom; world alignment keeps the edges neighbouring chunks share
+// bit-identical.
+static void addNoiseLayer(std::span<const TerrainOctave> octaves, int step,
+                          int originX, int originZ, std::vector<float> &out) {
+  constexpr int chunkSize = 32;
 
-  if (pathValue < 0.15f) {
-    const float h1 = db::perlin(wx * 0.008f, wz * 0.008f) * 4.0f;
-    const float h2 = db::perlin((wx + 2.0f) * 0.008f, wz * 0.008f) * 4.0f;
-    const float slope = std::abs(h2 - h1);
-    return slope < 0.8f;
+  if (step == 1) {
+    std::vector<float> noise(chunkSize * chunkSize);
+    for (const TerrainOctave &octave : octaves) {
+      db::perlin_grid(static_cast<float>(originX), static_cast<float>(originZ),
+                      1.0f, octave.frequency, octave.offset, chunkSize,
+                      chunkSize, noise.data());
+      for (int i = 0; i < chunkSize * chunkSize; ++i) {
+        out[i] += noise[i] * octave.amplitude;
+      }
+    }
+    return;
   }
 
-  const float secondaryPath = db::perlin(wx * 0.01f + 5000.0f, wz * 0.01f + 5000.0f);
-  return std::abs(secondaryPath) < 0.08f;
-}
-
-[[nodiscard]] float getPathInfluence(float wx, float wz) noexcept {
-  if (!isOnPath(wx, wz)) {
-    return 0.0f;
+  // Lattice with one extra point before and two after for the cubic taps
+  const int lx0 = floorDiv(originX, step) - 1;
+  const int lz0 = floorDiv(originZ, step) - 1;
+  const int lw = floorDiv(originX + chunkSize - 1, step) + 2 - lx0 + 1;
+  const int lh = floorDiv(originZ + chunkSize - 1, step) + 2 - lz0 + 1;
+
+  std::vector<float> lattice(lw * lh, 0.0f);
+  std::vector<float> noise(lw * lh);
+  for (const TerrainOctave &octave : octaves) {
+    db::perlin_grid(static_cast<float>(lx0 * step),
+                    static_cast<float>(lz0 * step), static_cast<float>(step),
+                    octave.frequency, octave.offset, lw, lh, noise.data());
+    for (int i = 0; i < lw * lh; ++i) {
+      lattice[i] += noise[i] * octave.amplitude;
+    }
   }
 
-  float influence = 0.7f;
+  struct Taps {
+    int first;
+    std::array<float, 4> weights;
+  };
+  const auto catmullRom = [step](int w, int latticeOrigin) {
+    const int cell = floorDiv(w, step);
+    const float t = static_cast<float>(w - cell * step) / static_cast<float>(step);
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return Taps{cell - 1 - latticeOrigin,
+                {0.5f * (-t3 + 2.0f * t2 - t), 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f),
+                 0.5f * (-3.0f * t3 + 4.0f * t2 + t), 0.5f * (t3 - t2)}};
+  };
+
+  // Separable: along x for every lattice row, then along z
+  std::vector<float> rows(lh * chunkSize);
+  for (int x = 0; x < chunkSize; ++x) {
+    const Taps taps = catmullRom(originX + x, lx0);
+    for (int r = 0; r < lh; ++r) {
+      const float *src = &lattice[r * lw + taps.first];
+      rows[r * chunkSize + x] = src[0] * taps.weights[0] + src[1] * taps.weights[1] +
+                                src[2] * taps.weights[2] + src[3] * taps.weights[3];
+    }
+  }
+  for (int z = 0; z < chunkSize; ++z) {
+    const Taps taps = catmullRom(originZ + z, lz0);
+    const float *r0 = &rows[taps.first * chunkSize];
+    for (int x = 0; x < chunkSize; ++x) {
+      out[z * chunkSize + x] += r0[x] * taps.weights[0] +
+                                r0[chunkSize + x] * taps.weights[1] +
+                                r0[2 * chunkSize + x] * taps.weights[2] +
+                                r0[3 * chunkSize + x] * taps.weights[3];
+    }
+  }
+}
 
-  for (float dx = -1.5f; dx <= 1.5f; dx += 1.5f) {
-    for (float dz = -1.5f; dz <= 1.5f; dz += 1.5f) {
-      if (dx == 0 && dz == 0) {
+std::vector<float> sampleTerrainHeights(int cx, int cz, bool multiRes) {
+  constexpr int chunkSize = 32;
+  constexpr int stride = chunkSize - 1;
+  const int originX = cx * stride;
+  const int originZ = cz * stride;
+
+  std::vector<float> heights(chunkSize * chunkSize, 0.0f);
+  std::vector<float> valleys(chunkSize * chunkSize, 0.0f);
+
+  if (multiRes) {
+    // Octaves that share a lattice step are summed before upsampling
+    std::vector<TerrainOctave> group;
+    std::array<bool, terrainOctaves.size()> done{};
+    for (std::size_t i = 0; i < terrainOctaves.size(); ++i) {
+      if (done[i]) {
         continue;
       }
-      if (!isOnPath(wx + dx, wz + dz)) {
-        influence *= 0.55f;
+      const int step = latticeStep(terrainOctaves[i].frequency);
+      group.clear();
+      for (std::size_t j = i; j < terrainOctaves.size(); ++j) {
+        if (!done[j] && latticeStep(terrainOctaves[j].frequency) == step) {
+          group.push_back(terrainOctaves[j]);
+          done[j] = true;
+        }
       }
+      addNoiseLayer(group, step, originX, originZ, heights);
+    }
+    addNoiseLayer({&valleyOctave, 1}, latticeStep(valleyOctave.frequency),
+                  originX, originZ, valleys);
+  } else {
+    // Exact: every octave at full resolution, summed in declaration order
+    for (const TerrainOctave &octave : terrainOctaves) {
+      addNoiseLayer({&octave, 1}, 1, originX, originZ, heights);
+    }
+    addNoiseLayer({&valleyOctave, 1}, 1, originX, originZ, valleys);
+  }
+
+  for (int i = 0; i < chunkSize * chunkSize; ++i) {
+    float height = heights[i];
+    const float valleyNoise = valleys[i];
+    if (valleyNoise < valleyShape.threshold) {
+      height += (valleyNoise - valleyShape.threshold) * valleyShape.depth;
     }
+    heights[i] = height + valleyShape.baseHeight;
   }
 
-  return influence;
+  return heights;
 }
 
-void generateChunk(int cx, int cz) {
+void smoothTerrainHeights(std::vector<float> &heights) {
   constexpr int chunkSize = 32;
-  constexpr int stride = chunkSize - 1;
 
-  Mesh mesh{};
-  mesh.vertexCount = chunkSize * chunkSize;
-  mesh.triangleCount = stride * stride * 2;
+  constexpr int edgeMargin = 1;
 
-  // Use new[] for raylib compatibility (needs to be freed with RL_FREE/free)
-  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
-  mesh.texcoords = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * sizeof(float))));
-  mesh.normals = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
-  mesh.colors = static_cast<unsigned char*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 4 * sizeof(unsigned char))));
-  mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(mesh.triangleCount * 3 * sizeof(unsigned short))));
+  for (int iter = 0; iter < terrainSmoothing.iterations; ++iter) {
+    std::vector<float> newHeights = heights;
+    for (int z = edgeMargin; z < chunkSize - edgeMargin; ++z) {
+      for (int x = edgeMargin; x < chunkSize - edgeMargin; ++x) {
+        const int idx = z * chunkSize + x;
+
+        float sum = heights[idx] * terrainSmoothing.centreWeight;
+        sum += heights[(z - 1) * chunkSize + x] * terrainSmoothing.neighbourWeight;
+        sum += heights[(z + 1) * chunkSize + x] * terrainSmoothing.neighbourWeight;
+        sum += heights[z * chunkSize + (x - 1)] * terrainSmoothing.neighbourWeight;
+        sum += heights[z * chunkSize + (x + 1)] * terrainSmoothing.neighbourWeight;
+        newHeights[idx] = sum;
+      }
+    }
+    heights = newHeights;
+  }
+}
 
-  std::vector<float> heights(chunkSize * chunkSize);
+ChunkFields generateChunkFields(int cx, int cz) {
+  constexpr int chunkSize = 32;
+  constexpr int stride = chunkSize - 1;
+
+  ChunkFields fields;
+  std::vector<float> heights;
   std::vector<float> moisture(chunkSize * chunkSize);
   std::vector<float> pathInfluence(chunkSize * chunkSize);
 
+  std::vector<float> moistureNoise(chunkSize * chunkSize);
+  {
+    const ProfileScope scope("chunk noise");
+    heights = sampleTerrainHeights(cx, cz, multiResTerrainNoise);
+    db::perlin_grid(static_cast<float>(cx * stride), static_cast<float>(cz * stride),
+                    1.0f, moistureShape.frequency, moistureShape.offset, chunkSize, chunkSize,
+                    moistureNoise.data());
+  }
+
+  // Profiler spans for the phases below; each emplace ends the last one
+  std::optional<ProfileScope> phase(std::in_place, "chunk paths");
   for (int z = 0; z < chunkSize; ++z) {
     for (int x = 0; x < chunkSize; ++x) {
       const float wx = static_cast<float>(cx * stride + x);
       const float wz = static_cast<float>(cz * stride + z);
       const int idx = z * chunkSize + x;
 
-      // MUCH LARGER scale terrain features - frequencies reduced dramatically
-      // Base terrain - very large rolling hills
-      float height = db::perlin(wx * 0.0015f, wz * 0.0015f) * 8.0f;
-
-      // Secondary large features (mountains/plateaus)
-      height += db::perlin(wx * 0.003f + 100.0f, wz * 0.003f + 100.0f) * 4.0f;
-
-      // Medium variation (gentle slopes)
-      height += db::perlin(wx * 0.006f + 200.0f, wz * 0.006f + 200.0f) * 1.5f;
-
-      // Fine detail (very subtle - barely noticeable)
-      height += db::perlin(wx * 0.015f + 300.0f, wz * 0.015f + 300.0f) * 0.4f;
-
-      // Very wide valleys
-      const float valleyNoise = db::perlin(wx * 0.001f + 500.0f, wz * 0.001f + 500.0f);
-      if (valleyNoise < -0.25f) {
-        height += (valleyNoise + 0.25f) * 3.0f; // Gentle broad valleys
-      }
-
-      heights[idx] = height + 3.0f;
-
       // Moisture
-      moisture[idx] = 0.5f + db::perlin(wx * 0.008f + 2000.0f, wz * 0.008f + 2000.0f) * 0.3f;
-      if (heights[idx] < 2.5f) {
-        moisture[idx] += 0.3f;
+      moisture[idx] = moistureShape.base + moistureNoise[idx] * moistureShape.noiseScale;
+      if (heights[idx] < moistureShape.lowlandHeight) {
+        moisture[idx] += moistureShape.lowlandBonus;
       }
       moisture[idx] = std::clamp(moisture[idx], 0.0f, 1.0f);
 
@@ -102,29 +267,12 @@ void generateChunk(int cx, int cz) {
     }
   }
 
-  // Reduced smoothing - the noise is already smooth at this scale
-  constexpr int smoothIterations = 4; // Less aggressive smoothing
-  constexpr int edgeMargin = 1;
+  phase.emplace("chunk smoothing");
+  smoothTerrainHeights(heights);
 
-  for (int iter = 0; iter < smoothIterations; ++iter) {
-    std::vector<float> newHeights = heights;
-    for (int z = edgeMargin; z < chunkSize - edgeMargin; ++z) {
-      for (int x = edgeMargin; x < chunkSize - edgeMargin; ++x) {
-        const int idx = z * chunkSize + x;
-
-        // Lighter smoothing - preserve more character
-        float sum = heights[idx] * 0.5f; // More center weight
-        sum += heights[(z - 1) * chunkSize + x] * 0.125f;
-        sum += heights[(z + 1) * chunkSize + x] * 0.125f;
-        sum += heights[z * chunkSize + (x - 1)] * 0.125f;
-        sum += heights[z * chunkSize + (x + 1)] * 0.125f;
-        newHeights[idx] = sum;
-      }
-    }
-    heights = newHeights;
-  }
-
-  // Generate mesh vertices with path coloring
+  // Vertex colors with path blending
+  phase.emplace("chunk colours");
+  std::vector<unsigned char> colors(chunkSize * chunkSize * 4);
   for (int z = 0; z < chunkSize; ++z) {
     for (int x = 0; x < chunkSize; ++x) {
       const int idx = z * chunkSize + x;
@@ -132,60 +280,39 @@ void generateChunk(int cx, int cz) {
       const float m = moisture[idx];
       const float pathVal = pathInfluence[idx];
 
-      mesh.vertices[idx * 3] = static_cast<float>(x);
-      mesh.vertices[idx * 3 + 1] = height * 5.0f;
-      mesh.vertices[idx * 3 + 2] = static_cast<float>(z);
-
-      mesh.texcoords[idx * 2] = static_cast<float>(x) / stride;
-      mesh.texcoords[idx * 2 + 1] = static_cast<float>(z) / stride;
-
-      unsigned char r, g, b;
-
-      if (height < 1.5f) {
-        r = static_cast<unsigned char>(45 + static_cast<int>(m * 15.0f));
-        g = static_cast<unsigned char>(50 + static_cast<int>(m * 20.0f));
-        b = static_cast<unsigned char>(35 + static_cast<int>(m * 10.0f));
-      } else if (height < 3.5f) {
-        r = static_cast<unsigned char>(60 + static_cast<int>(m * 15.0f));
-        g = static_cast<unsigned char>(65 + static_cast<int>(m * 20.0f));
-        b = 45;
-      } else if (height < 5.0f) {
-        r = 70;
-        g = 68;
-        b = 55;
-      } else {
-        r = 75;
-        g = 70;
-        b = 65;
-      }
-
-      if (pathVal > 0.0f) {
-        constexpr unsigned char pathR = 80;
-        constexpr unsigned char pathG = 75;
-        constexpr unsigned char pathB = 60;
-
-        r = static_cast<unsigned char>(r * (1.0f - pathVal) + pathR * pathVal);
-        g = static_cast<unsigned char>(g * (1.0f - pathVal) + pathG * pathVal);
-        b = static_cast<unsigned char>(b * (1.0f - pathVal) + pathB * pathVal);
+      const TerrainColourBand &band = *std::find_if(
+          terrainColourBands.begin(), std::prev(terrainColourBands.end()),
+          [height](const TerrainColourBand &b) { return height < b.maxHeight; });
+      for (std::size_t c = 0; c < 3; ++c) {
+        auto channel = static_cast<unsigned char>(
+            band.base[c] + static_cast<int>(m * band.moistureScale[c]));
+        if (pathVal > 0.0f) {
+          channel = static_cast<unsigned char>(channel * (1.0f - pathVal) +
+                                               pathColour[c] * pathVal);
+        }
+        colors[idx * 4 + c] = channel;
       }
-
-      mesh.colors[idx * 4] = r;
-      mesh.colors[idx * 4 + 1] = g;
-      mesh.colors[idx * 4 + 2] = b;
-      mesh.colors[idx * 4 + 3] = 255;
+      colors[idx * 4 + 3] = 255;
     }
   }
 
-  // Compute normals
+  // Compute normals from the mesh-scale heights
+  phase.emplace("chunk normals");
+  std::vector<float> meshHeights(chunkSize * chunkSize);
+  for (int i = 0; i < chunkSize * chunkSize; ++i) {
+    meshHeights[i] = heights[i] * 5.0f;
+  }
+
+  std::vector<float> normals(chunkSize * chunkSize * 3);
   for (int z = 0; z < chunkSize; ++z) {
     for (int x = 0; x < chunkSize; ++x) {
       const int idx = z * chunkSize + x;
-      const float h = mesh.vertices[idx * 3 + 1];
+      const float h = meshHeights[idx];
 
-      const float hx1 = (x > 0) ? mesh.vertices[(z * chunkSize + (x - 1)) * 3 + 1] : h;
-      const float hx2 = (x < chunkSize - 1) ? mesh.vertices[(z * chunkSize + (x + 1)) * 3 + 1] : h;
-      const float hz1 = (z > 0) ? mesh.vertices[((z - 1) * chunkSize + x) * 3 + 1] : h;
-      const float hz2 = (z < chunkSize - 1) ? mesh.vertices[((z + 1) * chunkSize + x) * 3 + 1] : h;
+      const float hx1 = (x > 0) ? meshHeights[z * chunkSize + (x - 1)] : h;
+      const float hx2 = (x < chunkSize - 1) ? meshHeights[z * chunkSize + (x + 1)] : h;
+      const float hz1 = (z > 0) ? meshHeights[(z - 1) * chunkSize + x] : h;
+      const float hz2 = (z < chunkSize - 1) ? meshHeights[(z + 1) * chunkSize + x] : h;
 
       const float dx = (hx2 - hx1) / 2.0f;
       const float dz = (hz2 - hz1) / 2.0f;
@@ -198,97 +325,167 @@ void generateChunk(int cx, int cz) {
         normal.z /= len;
       }
 
-      mesh.normals[idx * 3] = normal.x;
-      mesh.normals[idx * 3 + 1] = normal.y;
-      mesh.normals[idx * 3 + 2] = normal.z;
+      normals[idx * 3] = normal.x;
+      normals[idx * 3 + 1] = normal.y;
+      normals[idx * 3 + 2] = normal.z;
     }
   }
 
-  // Generate indices
-  int indexCount = 0;
-  for (int z = 0; z < stride; ++z) {
-    for (int x = 0; x < stride; ++x) {
-      const int topLeft = z * chunkSize + x;
-      const int topRight = topLeft + 1;
-      const int bottomLeft = (z + 1) * chunkSize + x;
-      const int bottomRight = bottomLeft + 1;
-
-      mesh.indices[indexCount++] = static_cast<unsigned short>(topLeft);
-      mesh.indices[indexCount++] = static_cast<unsigned short>(bottomLeft);
-      mesh.indices[indexCount++] = static_cast<unsigned short>(topRight);
-      mesh.indices[indexCount++] = static_cast<unsigned short>(topRight);
-      mesh.indices[indexCount++] = static_cast<unsigned short>(bottomLeft);
-      mesh.indices[indexCount++] = static_cast<unsigned short>(bottomRight);
-    }
+  // Coarser adaptive levels over the same vertices, in world-space heights
+  phase.emplace("chunk LODs");
+  const TerrainSurface surface = {meshHeights, colors};
+  for (std::size_t i = 0; i < terrainLodLevels.size(); ++i) {
+    fields.lodIndices[i] = triangulateTerrain(surface, terrainLodLevels[i]);
   }
 
-  UploadMesh(&mesh, false);
-  Model model = LoadModelFromMesh(mesh);
-  model.materials[0].shader = lightingShader;
-
-  Chunk chunk;
-  chunk.x = cx;
-  chunk.z = cz;
-  chunk.model = model;
-  chunk.heights = std::move(heights);
-  chunk.moisture = std::move(moisture);
-  chunk.vegetation = {}; // Will be populated by GenerateVegetationForChunk
-  
-  chunks[{cx, cz}] = std::move(chunk);
+  phase.reset();
+
+  fields.heights = std::move(heights);
+  fields.moisture = std::move(moisture);
+  fields.pathInfluence = std::move(pathInfluence);
+  fields.normals = std::move(normals);
+  fields.colors = std::move(colors);
+  return fields;
 }
 
-float getTerrainHeight(float wx, float wz) {
-  // Determine which chunk this position is in
-  constexpr int stride = 31;
-  const int cx = static_cast<int>(std::floor(wx / stride));
-  const int cz = static_cast<int>(std::floor(wz / stride));
-
-  // Check if chunk exists
-  const auto it = chunks.find({cx, cz});
-  if (it == chunks.end()) {
-    // Chunk not loaded, estimate height from noise
-    float height = 0.0f;
-    height += db::perlin(wx * 0.004f, wz * 0.004f) * 6.0f;
-    height += db::perlin(wx * 0.01f + 100.0f, wz * 0.01f + 100.0f) * 2.5f;
-    height += db::perlin(wx * 0.02f + 200.0f, wz * 0.02f + 200.0f) * 0.8f;
-    height += db::perlin(wx * 0.05f + 300.0f, wz * 0.05f + 300.0f) * 0.3f;
-
-    const float valleyNoise = db::perlin(wx * 0.003f + 500.0f, wz * 0.003f + 500.0f);
-    if (valleyNoise < -0.2f) {
-      height += (valleyNoise + 0.2f) * 2.5f;
+// Turns chunk fields, generated or baked, into meshes and chunk state
+static ChunkBuild assembleChunk(int cx, int cz, const ChunkFieldsView &fields) {
+  const ProfileScope scope("chunk assemble");
+  constexpr int chunkSize = 32;
+  constexpr int stride = chunkSize - 1;
+
+  Mesh mesh{};
+  mesh.vertexCount = chunkSize * chunkSize;
+  mesh.triangleCount = stride * stride * 2;
+
+  // Use new[] for raylib compatibility (needs to be freed with RL_FREE/free)
+  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.normals = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.colors = static_cast<unsigned char*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 4 * sizeof(unsigned char))));
+  // Texcoords and indices are the same for every chunk; see terrainMesh.cpp
+
+  float minHeight = fields.heights[0] * 5.0f;
+  float maxHeight = minHeight;
+  for (int z = 0; z < chunkSize; ++z) {
+    for (int x = 0; x < chunkSize; ++x) {
+      const int idx = z * chunkSize + x;
+      const float height = fields.heights[idx] * 5.0f;
+      mesh.vertices[idx * 3] = static_cast<float>(x);
+      mesh.vertices[idx * 3 + 1] = height;
+      mesh.vertices[idx * 3 + 2] = static_cast<float>(z);
+      minHeight = std::min(minHeight, height);
+      maxHeight = std::max(maxHeight, height);
     }
+  }
+  std::memcpy(mesh.normals, fields.normals.data(), fields.normals.size_bytes());
+  std::memcpy(mesh.colors, fields.colors.data(), fields.colors.size_bytes());
 
-    return (height + 3.0f) * 5.0f;
+  ChunkBuild build;
+  for (const std::span<const unsigned short> indices : fields.lodIndices) {
+    build.chunk.lodMeshes.push_back(buildTerrainLodMesh(mesh, indices));
+  }
+  build.chunk.minHeight = minHeight;
+  build.chunk.maxHeight = maxHeight;
+
+  build.mesh = mesh;
+  build.chunk.x = cx;
+  build.chunk.z = cz;
+  build.chunk.heights.assign(fields.heights.begin(), fields.heights.end());
+  build.chunk.moisture.assign(fields.moisture.begin(), fields.moisture.end());
+  build.grassField = BuildGrassField(build.chunk, fields.pathInfluence);
+  computeOccluderHeights(build.chunk);
+  build.chunk.waterPatches = BuildWaterPatches(build.chunk);
+  // The water surface counts as content, so culling keeps submerged chunks
+  build.chunk.contentTop =
+      build.chunk.waterPatches.empty() ? maxHeight : std::max(maxHeight, waterLevel);
+  {
+    const ProfileScope vegetationScope("chunk vegetation");
+    GenerateVegetationForChunk(build.chunk, fields.pathInfluence);
   }
 
-  // Get local position within chunk
-  float localX = wx - static_cast<float>(cx * stride);
-  float localZ = wz - static_cast<float>(cz * stride);
+  return build;
+}
 
-  // Clamp to chunk bounds
-  localX = std::clamp(localX, 0.0f, 31.0f);
-  localZ = std::clamp(localZ, 0.0f, 31.0f);
+ChunkBuild buildChunk(int cx, int cz) {
+  // Baked region files skip generation entirely; see worldBake.cpp
+  if (const std::optional<ChunkFieldsView> baked = FindBakedChunk(cx, cz)) {
+    return assembleChunk(cx, cz, *baked);
+  }
+  const ChunkFields fields = generateChunkFields(cx, cz);
+  return assembleChunk(cx, cz, fields.view());
+}
 
-  // Get the 4 surrounding vertices for bilinear interpolation
-  const int x0 = static_cast<int>(std::floor(localX));
-  const int z0 = static_cast<int>(std::floor(localZ));
-  const int x1 = std::min(x0 + 1, 31);
-  const int z1 = std::min(z0 + 1, 31);
+std::uint64_t TerrainGeneratorHash() {
+  // FNV-1a over every input that shapes generated chunk fields
+  std::uint64_t hash = 14695981039346656037ull;
+  const auto mix = [&hash](const auto &value) {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (std::size_t i = 0; i < sizeof(value); ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+  };
+
+  mix(terrainOctaves);
+  mix(valleyOctave);
+  mix(valleyShape);
+  mix(terrainSmoothing);
+  mix(moistureShape);
+  for (const TerrainColourBand &band : terrainColourBands) {
+    mix(band.maxHeight);
+    mix(band.base);
+    mix(band.moistureScale);
+  }
+  mix(pathColour);
+  mix(pathShape);
+  mix(maxLatticePhase);
+  mix(maxLatticeStep);
+  mix(minLatticeStep);
+  mix(multiResTerrainNoise);
+  mix(terrainLodLevels);
+  for (const Path &path : GetAuthoredPaths()) {
+    mix(path.width);
+    for (const Vector3 &point : path.points) {
+      mix(point);
+    }
+  }
+  return hash;
+}
 
-  const float fx = localX - static_cast<float>(x0);
-  const float fz = localZ - static_cast<float>(z0);
+void uploadChunk(ChunkBuild &&build) {
+  const ProfileScope scope("chunk upload");
+  // The arena keeps the only copy; the CPU meshes go once they're in
+  Chunk &chunk = build.chunk;
+  chunk.meshRanges.push_back(UploadTerrainMesh(build.mesh, chunk.x, chunk.z));
+  for (const Mesh &lod : chunk.lodMeshes) {
+    chunk.meshRanges.push_back(UploadTerrainLodMesh(lod, chunk.x, chunk.z));
+  }
+  chunk.grassTexture = UploadGrassField(build.grassField);
+  discardChunkBuild(build);
 
-  // Get heights from chunk data
-  const Chunk &chunk = it->second;
-  const float h00 = chunk.heights[z0 * 32 + x0];
-  const float h10 = chunk.heights[z0 * 32 + x1];
-  const float h01 = chunk.heights[z1 * 32 + x0];
-  const float h11 = chunk.heights[z1 * 32 + x1];
+  // A displaced chunk is one the player left too fast for it to be unloaded
+  if (std::optional<Chunk> displaced = chunks.insert(std::move(build.chunk))) {
+    unloadChunk(*displaced);
+  }
+}
 
-  // Bilinear interpolation
-  const float h0 = h00 * (1.0f - fx) + h10 * fx;
-  const float h1 = h01 * (1.0f - fx) + h11 * fx;
-  const float height = h0 * (1.0f - fz) + h1 * fz;
+void discardChunkBuild(ChunkBuild &build) {
+  // Only the CPU-side arrays; the arena has its own copy of anything uploaded
+  UnloadMesh(build.mesh);
+  build.mesh = {};
+  for (Mesh &lod : build.chunk.lodMeshes) {
+    UnloadMesh(lod);
+  }
+  build.chunk.lodMeshes.clear();
+  build.grassField = {};
+}
 
-  return height * 5.0f; // Scale same as mesh
+void unloadChunk(Chunk &chunk) {
+  for (const TerrainMeshRange &range : chunk.meshRanges) {
+    ReleaseTerrainMesh(range);
+  }
+  chunk.meshRanges.clear();
+  UnloadGrassField(chunk.grassTexture);
+  chunk.grassTexture = 0;
 }
+
+void generateChunk(int cx, int cz) { uploadChunk(buildChunk(cx, cz)); }
@@ -0,0 +1,212 @@
+#include "game.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// GPU grass. Each chunk uploads a 32x32 RGB32F texture of its vertices'
+// world height, path influence and moisture once, on upload. Drawing it is
+// one instanced draw of a single blade mesh: grass.vs turns gl_InstanceID
+// into a cell of a grassCells x grassCells grid over the chunk, hashes it
+// for jitter, height, facing and lean, reads the terrain under it from the
+// texture and sways it in the wind. Blades on paths or under water collapse
+// to nothing in the shader, so the CPU cost per chunk is a few uniforms.
+//
+// Farther chunks draw every grassStep-th cell along each side, with wider
+// blades, and the survivors are the same blades the nearer level draws.
+
+constexpr int grassCells = 128; // Blades per chunk side at full density
+constexpr float grassDrawDistance = 80.0f;
+constexpr float grassFadeStart = 60.0f;
+
+struct GrassLod {
+  float distance; // Nearest chunk point closer than this
+  int step;       // Cells per blade along each side
+};
+
+constexpr std::array<GrassLod, 3> grassLods = {{
+    {25.0f, 1},
+    {50.0f, 2},
+    {grassDrawDistance, 4},
+}};
+
+extern Shader grassShader;
+
+static Mesh bladeMesh{};
+static GrassStats grassStats{};
+
+// Three tapering segments and a tip; grass.vs shapes and places it
+static Mesh buildBladeMesh() {
+  constexpr int segments = 3;
+  Mesh mesh{};
+  mesh.vertexCount = segments * 2 + 1;
+  mesh.triangleCount = (segments - 1) * 2 + 1;
+  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(mesh.triangleCount * 3 * sizeof(unsigned short))));
+
+  int v = 0;
+  for (int i = 0; i < segments; ++i) {
+    const float y = static_cast<float>(i) / segments;
+    for (const float x : {-0.5f, 0.5f}) {
+      mesh.vertices[v++] = x;
+      mesh.vertices[v++] = y;
+      mesh.vertices[v++] = 0.0f;
+    }
+  }
+  mesh.vertices[v++] = 0.0f;
+  mesh.vertices[v++] = 1.0f;
+  mesh.vertices[v++] = 0.0f;
+
+  int index = 0;
+  for (int i = 0; i + 1 < segments; ++i) {
+    const auto left = static_cast<unsigned short>(i * 2);
+    for (const int corner : {0, 1, 3, 0, 3, 2}) {
+      mesh.indices[index++] = static_cast<unsigned short>(left + corner);
+    }
+  }
+  const auto last = static_cast<unsigned short>((segments - 1) * 2);
+  for (const int corner : {0, 1, 2}) {
+    mesh.indices[index++] = static_cast<unsigned short>(last + corner);
+  }
+
+  UploadMesh(&mesh, false);
+  return mesh;
+}
+
+void InitGrass() {
+  bladeMesh = buildBladeMesh();
+
+  if (grassShader.id != 0) {
+    SetShaderValue(grassShader, GetShaderLocation(grassShader, "waterLevel"), &waterLevel,
+                   SHADER_UNIFORM_FLOAT);
+    SetShaderValue(grassShader, GetShaderLocation(grassShader, "grassCells"), &grassCells,
+                   SHADER_UNIFORM_INT);
+    const Vector2 fade = {grassFadeStart, grassDrawDistance};
+    SetShaderValue(grassShader, GetShaderLocation(grassShader, "grassFade"), &fade,
+                   SHADER_UNIFORM_VEC2);
+  }
+  std::cout << "Grass ready (" << grassCells * grassCells << " blades per chunk)"
+            << std::endl;
+}
+
+std::vector<float> BuildGrassField(const Chunk &chunk, std::span<const float> pathInfluence) {
+  std::vector<float> field(chunk.heights.size() * 3);
+  for (std::size_t i = 0; i < chunk.heights.size(); ++i) {
+    field[i * 3] = chunk.heights[i] * 5.0f;
+    field[i * 3 + 1] = pathInfluence[i];
+    field[i * 3 + 2] = chunk.moisture[i];
+  }
+  return field;
+}
+
+unsigned int UploadGrassField(std::span<const float> field) {
+  if (field.empty()) {
+    return 0;
+  }
+  // Read with texelFetch, so the default filtering doesn't matter
+  constexpr int chunkSize = 32;
+  return rlLoadTexture(field.data(), chunkSize, chunkSize,
+                       RL_PIXELFORMAT_UNCOMPRESSED_R32G32B32, 1);
+}
+
+void UnloadGrassField(unsigned int texture) {
+  if (texture != 0) {
+    rlUnloadTexture(texture);
+  }
+}
+
+float NearestGrassDistance(std::span<const Chunk *const> visible, Vector3 eye) {
+  float nearest = fog.end;
+  if (!gpuGrass) {
+    return nearest;
+  }
+  for (const Chunk *chunk : visible) {
+    if (chunk->grassTexture != 0) {
+      const float distance = ChunkDistance(*chunk, eye);
+      if (distance < grassLods.back().distance) {
+        nearest = std::min(nearest, distance);
+      }
+    }
+  }
+  return nearest;
+}
+
+void DrawGrass(std::span<const Chunk *const> visible, const Camera &camera) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  grassStats = {};
+  if (!gpuGrass || grassShader.id == 0 || bladeMesh.vaoId == 0) {
+    return;
+  }
+
+  // raylib batches immediate-mode draws; flush them so they keep their order
+  rlDrawRenderBatchActive();
+
+  const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+  const auto time = static_cast<float>(GetTime());
+
+  rlEnableShader(grassShader.id);
+  rlSetUniformMatrix(grassShader.locs[SHADER_LOC_MATRIX_MVP], mvp);
+  rlSetUniform(GetShaderLocation(grassShader, "grassTime"), &time, RL_SHADER_UNIFORM_FLOAT, 1);
+  constexpr int fieldUnit = 0;
+  rlSetUniform(GetShaderLocation(grassShader, "grassField"), &fieldUnit,
+               RL_SHADER_UNIFORM_INT, 1);
+  const int coordLoc = GetShaderLocation(grassShader, "chunkCoord");
+  const int stepLoc = GetShaderLocation(grassShader, "grassStep");
+
+  // Blades are seen from both sides
+  rlDisableBackfaceCulling();
+  rlActiveTextureSlot(fieldUnit);
+  rlEnableVertexArray(bladeMesh.vaoId);
+  for (const Chunk *chunk : visible) {
+    if (chunk->grassTexture == 0) {
+      continue;
+    }
+
+    // Distance from the camera to the chunk's bounding box
+    constexpr float stride = 31.0f;
+    const float minX = static_cast<float>(chunk->x) * stride;
+    const float minZ = static_cast<float>(chunk->z) * stride;
+    const Vector3 &p = camera.position;
+    const float dx = std::max({minX - p.x, 0.0f, p.x - (minX + stride)});
+    const float dy = std::max({chunk->minHeight - p.y, 0.0f, p.y - chunk->maxHeight});
+    const float dz = std::max({minZ - p.z, 0.0f, p.z - (minZ + stride)});
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    const auto lod = std::find_if(grassLods.begin(), grassLods.end(),
+                                  [distance](const GrassLod &level) {
+                                    return distance < level.distance;
+                                  });
+    if (lod == grassLods.end()) {
+      continue;
+    }
+
+    const int coord[2] = {chunk->x, chunk->z};
+    rlSetUniform(coordLoc, coord, RL_SHADER_UNIFORM_IVEC2, 1);
+    rlSetUniform(stepLoc, &lod->step, RL_SHADER_UNIFORM_INT, 1);
+    rlEnableTexture(chunk->grassTexture);
+
+    const int perSide = grassCells / lod->step;
+    rlDrawVertexArrayElementsInstanced(0, bladeMesh.triangleCount * 3, nullptr,
+                                       perSide * perSide);
+    ++grassStats.chunks;
+    ++grassStats.drawCalls;
+    grassStats.blades += perSide * perSide;
+  }
+  rlDisableVertexArray();
+  rlDisableTexture();
+  rlDisableShader();
+  rlEnableBackfaceCulling();
+
+  grassStats.microseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+}
+
+GrassStats GetGrassStats() { return grassStats; }
+
+void CleanupGrass() {
+  UnloadMesh(bladeMesh);
+  bladeMesh = {};
+}
@@ -0,0 +1,119 @@
+#include "game.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+constexpr int chunkSize = 32;
+constexpr int stride = chunkSize - 1;
+constexpr int tileVertices = chunkSize * chunkSize;
+constexpr int worldChunks = WORLD_CHUNK_MAX - WORLD_CHUNK_MIN + 1; // Per axis
+
+static std::vector<float> worldHeights; // worldChunks^2 tiles, empty until built
+
+void BuildWorldHeightfield() {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  worldHeights.assign(static_cast<std::size_t>(worldChunks * worldChunks * tileVertices), 0.0f);
+
+  // Same pipeline as buildChunk(), so the field matches the meshes exactly.
+  // Baked chunks already hold the smoothed heights.
+  std::atomic<int> nextRow{0};
+  std::vector<std::thread> builders;
+  const unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned int i = 0; i < count; ++i) {
+    builders.emplace_back([&nextRow] {
+      for (int row = nextRow++; row < worldChunks; row = nextRow++) {
+        for (int col = 0; col < worldChunks; ++col) {
+          const int cx = WORLD_CHUNK_MIN + col;
+          const int cz = WORLD_CHUNK_MIN + row;
+          float *tile = &worldHeights[static_cast<std::size_t>((row * worldChunks + col) * tileVertices)];
+          if (const std::optional<ChunkFieldsView> baked = FindBakedChunk(cx, cz)) {
+            std::copy(baked->heights.begin(), baked->heights.end(), tile);
+            continue;
+          }
+          std::vector<float> heights = sampleTerrainHeights(cx, cz, multiResTerrainNoise);
+          smoothTerrainHeights(heights);
+          std::copy(heights.begin(), heights.end(), tile);
+        }
+      }
+    });
+  }
+  for (auto &builder : builders) {
+    builder.join();
+  }
+
+  const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  std::cout << "World heightfield: " << worldChunks << "x" << worldChunks
+            << " chunks, " << worldHeights.size() * sizeof(float) / (1024 * 1024)
+            << " MB, built in " << ms << " ms" << std::endl;
+}
+
+void UnloadWorldHeightfield() {
+  worldHeights.clear();
+  worldHeights.shrink_to_fit();
+}
+
+std::span<const float> GetWorldHeightTile(int cx, int cz) {
+  if (worldHeights.empty() || cx < WORLD_CHUNK_MIN || cx > WORLD_CHUNK_MAX ||
+      cz < WORLD_CHUNK_MIN || cz > WORLD_CHUNK_MAX) {
+    return {};
+  }
+  const int tile = (cz - WORLD_CHUNK_MIN) * worldChunks + (cx - WORLD_CHUNK_MIN);
+  return {&worldHeights[static_cast<std::size_t>(tile * tileVertices)], tileVertices};
+}
+
+float getTerrainHeight(float wx, float wz) {
+  // Determine which chunk this position is in
+  const int cx = static_cast<int>(std::floor(wx / stride));
+  const int cz = static_cast<int>(std::floor(wz / stride));
+
+  std::span<const float> tile = GetWorldHeightTile(cx, cz);
+  if (tile.empty()) {
+    // Outside the bounded world: a loaded chunk, or the chunk's own heights.
+    // The last generated tile is kept, as the player at the world's edge
+    // asks about the same chunk every frame.
+    if (const Chunk *chunk = chunks.find(cx, cz)) {
+      tile = chunk->heights;
+    } else {
+      struct GeneratedTile {
+        int cx = 0, cz = 0;
+        std::vector<float> heights;
+      };
+      thread_local GeneratedTile generated;
+      if (generated.heights.empty() || generated.cx != cx || generated.cz != cz) {
+        generated.heights = sampleTerrainHeights(cx, cz, multiResTerrainNoise);
+        smoothTerrainHeights(generated.heights);
+        generated.cx = cx;
+        generated.cz = cz;
+      }
+      tile = generated.heights;
+    }
+  }
+
+  // Get local position within chunk
+  const float localX = std::clamp(wx - static_cast<float>(cx * stride), 0.0f, 31.0f);
+  const float localZ = std::clamp(wz - static_cast<float>(cz * stride), 0.0f, 31.0f);
+
+  // Get the 4 surrounding vertices for bilinear interpolation
+  const int x0 = std::min(static_cast<int>(localX), stride - 1);
+  const int z0 = std::min(static_cast<int>(localZ), stride - 1);
+  const float fx = localX - static_cast<float>(x0);
+  const float fz = localZ - static_cast<float>(z0);
+
+  const float h00 = tile[z0 * chunkSize + x0];
+  const float h10 = tile[z0 * chunkSize + x0 + 1];
+  const float h01 = tile[(z0 + 1) * chunkSize + x0];
+  const float h11 = tile[(z0 + 1) * chunkSize + x0 + 1];
+
+  // Bilinear interpolation
+  const float h0 = h00 * (1.0f - fx) + h10 * fx;
+  const float h1 = h01 * (1.0f - fx) + h11 * fx;
+  const float height = h0 * (1.0f - fz) + h1 * fz;
+
+  return height * 5.0f; // Scale same as mesh
+}
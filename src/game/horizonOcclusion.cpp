@@ -0,0 +1,219 @@
+#include "../core/profiler.h"
+#include "game.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Horizon occlusion. Terrain is a heightfield, so from the eye every
+// direction has a horizon: the steepest slope (rise over horizontal
+// distance) of the terrain crossed so far. Anything further out in that
+// direction and below that slope is hidden.
+//
+// Chunks are walked in Chebyshev rings around the camera chunk, which every
+// ray from the eye crosses in order. Each chunk in a ring is tested against
+// the horizon left by the rings inside it, then the ring's terrain raises the
+// horizon for the next one. Both sides are conservative: an occluder cell
+// only raises the directions it fully covers, with its lowest slope, and a
+// chunk is only hidden if its highest slope is under the horizon in every
+// direction it touches.
+
+constexpr int chunkSize = 32;
+constexpr int stride = chunkSize - 1;
+constexpr int horizonBins = 1024; // Over the full circle
+constexpr int fineOccluderRings = 2; // Beyond this, occluder cells merge 2x2
+constexpr float binWidth = 4.0f / horizonBins;
+
+static std::array<float, horizonBins> horizon; // Slope per direction
+static std::vector<const Chunk *> ordered;
+static std::vector<const Chunk *> visibleChunks;
+static OcclusionStats occlusionStats{};
+
+// Monotonic in the angle of (dx, dz), in [0, 4), without trig. Bins are
+// uneven in real angle, which doesn't matter for a conservative test.
+[[nodiscard]] static float pseudoAngle(float dx, float dz) noexcept {
+  const float p = dx / (std::abs(dx) + std::abs(dz));
+  return dz >= 0.0f ? 1.0f - p : 3.0f + p;
+}
+
+[[nodiscard]] static int binOf(int bin) noexcept {
+  return bin & (horizonBins - 1);
+}
+
+// Horizontal footprint of a chunk or cell, seen from the eye
+struct Footprint {
+  float x0, z0, x1, z1;
+
+  [[nodiscard]] bool contains(const Vector3 &eye) const noexcept {
+    return eye.x >= x0 && eye.x <= x1 && eye.z >= z0 && eye.z <= z1;
+  }
+
+  [[nodiscard]] float nearest(const Vector3 &eye) const noexcept {
+    const float dx = std::max({x0 - eye.x, 0.0f, eye.x - x1});
+    const float dz = std::max({z0 - eye.z, 0.0f, eye.z - z1});
+    return std::sqrt(dx * dx + dz * dz);
+  }
+
+  [[nodiscard]] float farthest(const Vector3 &eye) const noexcept {
+    const float dx = std::max(std::abs(x0 - eye.x), std::abs(x1 - eye.x));
+    const float dz = std::max(std::abs(z0 - eye.z), std::abs(z1 - eye.z));
+    return std::sqrt(dx * dx + dz * dz);
+  }
+
+  // Pseudo-angle range covered, from <= to. Only valid with the eye outside,
+  // where the range is under half a turn. May extend past [0, 4).
+  [[nodiscard]] std::pair<float, float> directions(const Vector3 &eye) const noexcept {
+    const float centre =
+        pseudoAngle((x0 + x1) * 0.5f - eye.x, (z0 + z1) * 0.5f - eye.z);
+    float from = 0.0f;
+    float to = 0.0f;
+    for (const auto &[x, z] : {std::pair{x0, z0}, {x1, z0}, {x0, z1}, {x1, z1}}) {
+      float delta = pseudoAngle(x - eye.x, z - eye.z) - centre;
+      if (delta >= 2.0f) {
+        delta -= 4.0f;
+      } else if (delta < -2.0f) {
+        delta += 4.0f;
+      }
+      from = std::min(from, delta);
+      to = std::max(to, delta);
+    }
+    return {centre + from, centre + to};
+  }
+};
+
+[[nodiscard]] static Footprint chunkFootprint(const Chunk &chunk) noexcept {
+  const float x = static_cast<float>(chunk.x * stride);
+  const float z = static_cast<float>(chunk.z * stride);
+  return {x, z, x + stride, z + stride};
+}
+
+[[nodiscard]] static bool isHidden(const Chunk &chunk, const Vector3 &eye) {
+  const Footprint footprint = chunkFootprint(chunk);
+  if (footprint.contains(eye)) {
+    return false;
+  }
+
+  // Steepest the chunk (or anything drawn with it) can appear
+  const float rise = chunk.contentTop - eye.y;
+  const float slope =
+      rise / (rise >= 0.0f ? footprint.nearest(eye) : footprint.farthest(eye));
+
+  const auto [from, to] = footprint.directions(eye);
+  const int last = static_cast<int>(std::floor(to / binWidth));
+  for (int bin = static_cast<int>(std::floor(from / binWidth)); bin <= last; ++bin) {
+    if (horizon[binOf(bin)] <= slope) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void computeOccluderHeights(Chunk &chunk) {
+  // LOD meshes may dip this far below the full grid, which never dips below
+  // the lowest vertex of a cell
+  const float lodSlack = terrainLodLevels.back().maxError;
+  for (int cz = 0; cz < occluderCells; ++cz) {
+    for (int cx = 0; cx < occluderCells; ++cx) {
+      float lowest = std::numeric_limits<float>::max();
+      for (int z = cz * occluderCellQuads; z <= std::min((cz + 1) * occluderCellQuads, stride); ++z) {
+        for (int x = cx * occluderCellQuads; x <= std::min((cx + 1) * occluderCellQuads, stride); ++x) {
+          lowest = std::min(lowest, chunk.heights[static_cast<std::size_t>(z * chunkSize + x)]);
+        }
+      }
+      chunk.occluderHeights[static_cast<std::size_t>(cz * occluderCells + cx)] =
+          lowest * 5.0f - lodSlack;
+    }
+  }
+}
+
+// Raises the horizon with the chunk's terrain, in blocks of merge x merge
+// occluder cells. Far away a single cell covers hardly any whole bins.
+static void raiseHorizon(const Chunk &chunk, const Vector3 &eye, int merge) {
+  const Footprint footprint = chunkFootprint(chunk);
+  for (int cz = 0; cz < occluderCells; cz += merge) {
+    for (int cx = 0; cx < occluderCells; cx += merge) {
+      const Footprint block = {
+          footprint.x0 + static_cast<float>(cx * occluderCellQuads),
+          footprint.z0 + static_cast<float>(cz * occluderCellQuads),
+          footprint.x0 + static_cast<float>(std::min((cx + merge) * occluderCellQuads, stride)),
+          footprint.z0 + static_cast<float>(std::min((cz + merge) * occluderCellQuads, stride))};
+      if (block.contains(eye)) {
+        continue;
+      }
+
+      float lowest = std::numeric_limits<float>::max();
+      for (int z = cz; z < cz + merge; ++z) {
+        for (int x = cx; x < cx + merge; ++x) {
+          lowest = std::min(lowest, chunk.occluderHeights[static_cast<std::size_t>(z * occluderCells + x)]);
+        }
+      }
+      const float rise = lowest - eye.y;
+      const float slope = rise / (rise >= 0.0f ? block.farthest(eye) : block.nearest(eye));
+
+      // Only directions whose whole bin crosses the block
+      const auto [from, to] = block.directions(eye);
+      const int last = static_cast<int>(std::floor(to / binWidth)) - 1;
+      for (int bin = static_cast<int>(std::ceil(from / binWidth)); bin <= last; ++bin) {
+        float &horizonSlope = horizon[binOf(bin)];
+        horizonSlope = std::max(horizonSlope, slope);
+      }
+    }
+  }
+}
+
+std::span<const Chunk *const> OccludeChunks(const Camera &camera,
+                                            std::span<const Chunk *const> candidates) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  const ProfileScope scope("horizon occlusion");
+
+  visibleChunks.clear();
+  if (!horizonOcclusion) {
+    visibleChunks.assign(candidates.begin(), candidates.end());
+    occlusionStats = {static_cast<int>(candidates.size()), 0, 0.0f};
+    return visibleChunks;
+  }
+
+  const Vector3 eye = camera.position;
+  const int cx = static_cast<int>(std::floor(eye.x / stride));
+  const int cz = static_cast<int>(std::floor(eye.z / stride));
+  const auto ringOf = [cx, cz](const Chunk *chunk) {
+    return std::max(std::abs(chunk->x - cx), std::abs(chunk->z - cz));
+  };
+
+  // Stable, so each ring keeps the near-to-far order it came in
+  ordered.assign(candidates.begin(), candidates.end());
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [&ringOf](const Chunk *a, const Chunk *b) { return ringOf(a) < ringOf(b); });
+
+  horizon.fill(-std::numeric_limits<float>::infinity());
+  for (std::size_t ringStart = 0; ringStart < ordered.size();) {
+    const int ring = ringOf(ordered[ringStart]);
+    std::size_t ringEnd = ringStart;
+    while (ringEnd < ordered.size() && ringOf(ordered[ringEnd]) == ring) {
+      ++ringEnd;
+    }
+
+    for (std::size_t i = ringStart; i < ringEnd; ++i) {
+      if (!isHidden(*ordered[i], eye)) {
+        visibleChunks.push_back(ordered[i]);
+      }
+    }
+    if (ringEnd < ordered.size()) {
+      for (std::size_t i = ringStart; i < ringEnd; ++i) {
+        raiseHorizon(*ordered[i], eye, ring <= fineOccluderRings ? 1 : 2);
+      }
+    }
+    ringStart = ringEnd;
+  }
+
+  occlusionStats.tested = static_cast<int>(candidates.size());
+  occlusionStats.occluded = static_cast<int>(candidates.size() - visibleChunks.size());
+  occlusionStats.microseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+  return visibleChunks;
+}
+
+OcclusionStats GetOcclusionStats() { return occlusionStats; }
@@ -0,0 +1,175 @@
+#include "game.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Octahedral impostors. A model is rendered orthographically from
+// impostorViews x impostorViews directions over the upper hemisphere, laid
+// out by hemi-octahedral mapping, into two atlases: albedo with coverage in
+// alpha, and normal with depth in alpha. Far away each instance is one
+// camera-facing quad; fragment.glsl's IMPOSTOR path blends the four views
+// around the eye direction, lights them with the baked normals and writes
+// the baked depth.
+//
+// The shader rebuilds each view's direction and basis, so the layout here
+// must match its hemiOctDecode and its up vector rule.
+
+constexpr int impostorViews = 8;      // Per side
+constexpr int impostorCellSize = 128; // Pixels per view
+constexpr int impostorAtlasSize = impostorViews * impostorCellSize;
+
+extern Shader impostorShader;
+
+static Mesh impostorQuad{};
+
+static Vector3 hemiOctDecode(float ex, float ez) {
+  const float x = (ex + ez) * 0.5f;
+  const float z = (ex - ez) * 0.5f;
+  return Vector3Normalize({x, 1.0f - std::abs(x) - std::abs(z), z});
+}
+
+static Mesh buildImpostorQuad() {
+  Mesh mesh{};
+  mesh.vertexCount = 4;
+  mesh.triangleCount = 2;
+  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(mesh.triangleCount * 3 * sizeof(unsigned short))));
+  constexpr float corners[4][3] = {{-1.0f, -1.0f, 0.0f}, {1.0f, -1.0f, 0.0f},
+                                   {1.0f, 1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f}};
+  std::copy_n(&corners[0][0], 12, mesh.vertices);
+  constexpr unsigned short indices[6] = {0, 1, 2, 0, 2, 3};
+  std::copy_n(indices, 6, mesh.indices);
+  UploadMesh(&mesh, false);
+  return mesh;
+}
+
+Shader LoadImpostorShader() {
+  Shader shader = LoadLightingShader("#define IMPOSTOR\n", "src/shaders/impostor.vs");
+  if (shader.id != 0 && shader.id != rlGetShaderIdDefault()) {
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+  }
+  return shader;
+}
+
+VegetationImpostor BakeVegetationImpostor(const Model &model, const Matrix &fit) {
+  if (impostorQuad.vaoId == 0) {
+    impostorQuad = buildImpostorQuad();
+  }
+
+  // Bounding sphere of the fitted model
+  const BoundingBox box = GetModelBoundingBox(model);
+  Vector3 low = {1e9f, 1e9f, 1e9f};
+  Vector3 high = {-1e9f, -1e9f, -1e9f};
+  for (int corner = 0; corner < 8; ++corner) {
+    const Vector3 p = Vector3Transform({(corner & 1) != 0 ? box.max.x : box.min.x,
+                                        (corner & 2) != 0 ? box.max.y : box.min.y,
+                                        (corner & 4) != 0 ? box.max.z : box.min.z},
+                                       fit);
+    low = Vector3Min(low, p);
+    high = Vector3Max(high, p);
+  }
+  const Vector3 centre = Vector3Scale(Vector3Add(low, high), 0.5f);
+  const float radius = std::max(Vector3Distance(low, high) * 0.5f, 0.01f);
+
+  VegetationImpostor impostor{};
+  impostor.radius = radius;
+  impostor.centreY = centre.y;
+  impostor.albedo = LoadRenderTexture(impostorAtlasSize, impostorAtlasSize);
+  impostor.normalDepth = LoadRenderTexture(impostorAtlasSize, impostorAtlasSize);
+  impostor.material = LoadMaterialDefault();
+  impostor.material.maps[MATERIAL_MAP_ALBEDO].texture = impostor.albedo.texture;
+  impostor.material.maps[MATERIAL_MAP_NORMAL].texture = impostor.normalDepth.texture;
+
+  const Shader albedoShader =
+      LoadLightingShader("#define IMPOSTOR_BAKE\n#define IMPOSTOR_BAKE_ALBEDO\n");
+  const Shader normalDepthShader = LoadLightingShader("#define IMPOSTOR_BAKE\n");
+
+  for (RenderTexture2D *target : {&impostor.albedo, &impostor.normalDepth}) {
+    const bool albedo = target == &impostor.albedo;
+    const Shader &shader = albedo ? albedoShader : normalDepthShader;
+    BeginTextureMode(*target);
+    // Empty texels: no coverage, and farthest depth
+    ClearBackground(albedo ? BLANK : Color{128, 255, 128, 255});
+    // Alpha is data here, not blending
+    rlDisableColorBlend();
+    rlDisableBackfaceCulling();
+    rlEnableDepthTest();
+
+    for (int j = 0; j < impostorViews; ++j) {
+      for (int i = 0; i < impostorViews; ++i) {
+        const float ex = static_cast<float>(i) / (impostorViews - 1) * 2.0f - 1.0f;
+        const float ez = static_cast<float>(j) / (impostorViews - 1) * 2.0f - 1.0f;
+        const Vector3 view = hemiOctDecode(ex, ez);
+        const Vector3 up = std::abs(view.y) > 0.999f ? Vector3{0.0f, 0.0f, 1.0f}
+                                                      : Vector3{0.0f, 1.0f, 0.0f};
+
+        rlDrawRenderBatchActive();
+        rlViewport(i * impostorCellSize, j * impostorCellSize, impostorCellSize,
+                   impostorCellSize);
+        rlSetMatrixProjection(MatrixOrtho(-radius, radius, -radius, radius, radius, 3.0f * radius));
+        rlSetMatrixModelview(
+            MatrixLookAt(Vector3Add(centre, Vector3Scale(view, 2.0f * radius)), centre, up));
+        for (int m = 0; m < model.meshCount; ++m) {
+          Material material = model.materials[model.meshMaterial[m]];
+          material.shader = shader;
+          DrawMesh(model.meshes[m], material, fit);
+        }
+      }
+    }
+
+    rlEnableBackfaceCulling();
+    rlEnableColorBlend();
+    EndTextureMode();
+
+    GenTextureMipmaps(&target->texture);
+    SetTextureFilter(target->texture, TEXTURE_FILTER_TRILINEAR);
+  }
+  impostor.material.maps[MATERIAL_MAP_ALBEDO].texture = impostor.albedo.texture;
+  impostor.material.maps[MATERIAL_MAP_NORMAL].texture = impostor.normalDepth.texture;
+
+  UnloadShader(albedoShader);
+  UnloadShader(normalDepthShader);
+  return impostor;
+}
+
+std::size_t GetImpostorAtlasBytes() {
+  // Two RGBA8 atlases with full mip chains
+  constexpr std::size_t level0 = static_cast<std::size_t>(impostorAtlasSize) * impostorAtlasSize * 4;
+  return 2 * level0 * 4 / 3;
+}
+
+void DrawVegetationImpostors(const VegetationImpostor &impostor,
+                             std::span<const Matrix> transforms, Vector2 fade) {
+  if (transforms.empty() || impostorShader.id == 0) {
+    return;
+  }
+
+  constexpr auto views = static_cast<float>(impostorViews);
+  SetShaderValue(impostorShader, GetShaderLocation(impostorShader, "impostorViews"), &views,
+                 SHADER_UNIFORM_FLOAT);
+  SetShaderValue(impostorShader, GetShaderLocation(impostorShader, "impostorRadius"),
+                 &impostor.radius, SHADER_UNIFORM_FLOAT);
+  SetShaderValue(impostorShader, GetShaderLocation(impostorShader, "impostorCentreY"),
+                 &impostor.centreY, SHADER_UNIFORM_FLOAT);
+  SetShaderValue(impostorShader, GetShaderLocation(impostorShader, "impostorFade"), &fade,
+                 SHADER_UNIFORM_VEC2);
+
+  Material material = impostor.material;
+  material.shader = impostorShader;
+  DrawMeshInstanced(impostorQuad, material, transforms.data(),
+                    static_cast<int>(transforms.size()));
+}
+
+void UnloadVegetationImpostor(VegetationImpostor &impostor) {
+  UnloadRenderTexture(impostor.albedo);
+  UnloadRenderTexture(impostor.normalDepth);
+  // The material's textures are the atlases, just unloaded
+  MemFree(impostor.material.maps);
+  impostor = {};
+}
+
+void UnloadImpostorQuad() {
+  UnloadMesh(impostorQuad);
+  impostorQuad = {};
+}
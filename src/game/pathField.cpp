@@ -0,0 +1,408 @@
+#include "db_perlin.hpp"
+#include "game.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Path influence field for the bounded world.
+//
+// The procedural path network is rasterized lazily in 32x32 tiles (one byte
+// per integer world position) the first time anything samples them, and then
+// kept for the whole session. A tile build batches the path noise for its own
+// points, then only for the 1.5-unit neighbours of points that are on a path,
+// sharing neighbours on a half-unit lattice. Authored Path polylines are
+// stamped in on top. Outside the field the live evaluation is used.
+
+constexpr int pathTileSize = 32;
+constexpr int pathFieldTiles = 76; // Per axis, covers +-1216 world units
+constexpr int pathFieldOrigin = -(pathFieldTiles / 2) * pathTileSize;
+
+// Neighbour samples sit 1.5 units away, i.e. 3 cells on the half-unit lattice
+constexpr int pathNeighbourCells = 3;
+constexpr int pathLatticeSize = (pathTileSize - 1) * 2 + pathNeighbourCells * 2 + 1;
+
+// Byte codes: 0 = no path, 1..9 = procedural path with 0..8 off-path
+// neighbours, 10..255 = authored path strength
+constexpr int proceduralCodeCount = 9;
+constexpr int authoredCodeFirst = 1 + proceduralCodeCount;
+constexpr int authoredCodeLevels = 255 - authoredCodeFirst;
+constexpr float pathMaxInfluence = pathShape.maxInfluence;
+constexpr float pathNeighbourFalloff = pathShape.neighbourFalloff;
+
+struct PathTile {
+  std::array<unsigned char, pathTileSize * pathTileSize> codes;
+  // isOnPathIgnoringSlope() at the same positions (procedural only)
+  std::array<bool, pathTileSize * pathTileSize> band;
+};
+
+static std::array<std::atomic<PathTile *>, pathFieldTiles * pathFieldTiles>
+    pathTiles{};
+static std::vector<Path> authoredPaths;
+static std::atomic<int> builtPathTiles{0};
+
+static const std::array<float, 256> pathCodeValues = [] {
+  std::array<float, 256> values{};
+  // Repeated multiply, exactly like the live evaluation accumulates it
+  float influence = pathMaxInfluence;
+  for (int k = 0; k < proceduralCodeCount; ++k) {
+    values[1 + k] = influence;
+    influence *= pathNeighbourFalloff;
+  }
+  for (int i = 0; i <= authoredCodeLevels; ++i) {
+    values[authoredCodeFirst + i] = pathMaxInfluence *
+                                    static_cast<float>(i + 1) /
+                                    static_cast<float>(authoredCodeLevels + 1);
+  }
+  return values;
+}();
+
+[[nodiscard]] static bool inPrimaryPathBand(float wx, float wz) noexcept {
+  const PathShape &s = pathShape;
+  const float pathNoise1 = db::perlin(wx * s.frequency1 + s.offset1, wz * s.frequency1 + s.offset1);
+  const float pathNoise2 = db::perlin(wx * s.frequency2 + s.offset2, wz * s.frequency2 + s.offset2);
+  return std::abs(pathNoise1) + std::abs(pathNoise2) * s.weight2 < s.threshold;
+}
+
+[[nodiscard]] static bool inSecondaryPathBand(float wx, float wz) noexcept {
+  const PathShape &s = pathShape;
+  const float secondaryPath = db::perlin(wx * s.secondaryFrequency + s.secondaryOffset,
+                                         wz * s.secondaryFrequency + s.secondaryOffset);
+  return std::abs(secondaryPath) < s.secondaryThreshold;
+}
+
+[[nodiscard]] static bool isOnPath(float wx, float wz) noexcept {
+  const PathShape &s = pathShape;
+  if (inPrimaryPathBand(wx, wz)) {
+    const float h1 = db::perlin(wx * s.slopeFrequency, wz * s.slopeFrequency) * s.slopeScale;
+    const float h2 = db::perlin((wx + s.slopeStep) * s.slopeFrequency, wz * s.slopeFrequency) *
+                     s.slopeScale;
+    const float slope = std::abs(h2 - h1);
+    return slope < s.maxSlope;
+  }
+  return inSecondaryPathBand(wx, wz);
+}
+
+bool isOnPathIgnoringSlope(float wx, float wz) noexcept {
+  return inPrimaryPathBand(wx, wz) || inSecondaryPathBand(wx, wz);
+}
+
+float evaluatePathInfluence(float wx, float wz) noexcept {
+  if (!isOnPath(wx, wz)) {
+    return 0.0f;
+  }
+
+  float influence = pathMaxInfluence;
+
+  for (float dx = -1.5f; dx <= 1.5f; dx += 1.5f) {
+    for (float dz = -1.5f; dz <= 1.5f; dz += 1.5f) {
+      if (dx == 0 && dz == 0) {
+        continue;
+      }
+      if (!isOnPath(wx + dx, wz + dz)) {
+        influence *= pathNeighbourFalloff;
+      }
+    }
+  }
+
+  return influence;
+}
+
+[[nodiscard]] static float segmentDistance(float px, float pz, const Vector3 &a,
+                                           const Vector3 &b) noexcept {
+  const float abx = b.x - a.x;
+  const float abz = b.z - a.z;
+  const float lenSq = abx * abx + abz * abz;
+  float t = 0.0f;
+  if (lenSq > 0.0f) {
+    t = std::clamp(((px - a.x) * abx + (pz - a.z) * abz) / lenSq, 0.0f, 1.0f);
+  }
+  const float dx = px - (a.x + abx * t);
+  const float dz = pz - (a.z + abz * t);
+  return std::sqrt(dx * dx + dz * dz);
+}
+
+static void stampAuthoredPaths(PathTile &tile, int x0, int z0) {
+  for (const Path &path : authoredPaths) {
+    const float halfWidth = path.width * 0.5f;
+    if (path.points.empty() || halfWidth <= 0.0f) {
+      continue;
+    }
+
+    for (int j = 0; j < pathTileSize; ++j) {
+      for (int i = 0; i < pathTileSize; ++i) {
+        const float px = static_cast<float>(x0 + i);
+        const float pz = static_cast<float>(z0 + j);
+
+        float dist = segmentDistance(px, pz, path.points.front(), path.points.front());
+        for (std::size_t s = 1; s < path.points.size(); ++s) {
+          dist = std::min(dist, segmentDistance(px, pz, path.points[s - 1],
+                                                path.points[s]));
+        }
+        if (dist >= halfWidth) {
+          continue;
+        }
+
+        // Full strength over the inner half of the width, fading to the edge
+        const float strength = std::clamp(2.0f * (1.0f - dist / halfWidth), 0.0f, 1.0f);
+        const int level = static_cast<int>(std::lround(strength * authoredCodeLevels));
+        if (level == 0) {
+          continue;
+        }
+
+        unsigned char &code = tile.codes[j * pathTileSize + i];
+        const auto authored = static_cast<unsigned char>(authoredCodeFirst + level - 1);
+        if (pathCodeValues[authored] > pathCodeValues[code]) {
+          code = authored;
+        }
+      }
+    }
+  }
+}
+
+// isOnPath() for many points at once, with every noise term batched; and
+// isOnPathIgnoringSlope() into band, if given
+static void isOnPathBatch(const std::vector<float> &wxs,
+                          const std::vector<float> &wzs,
+                          std::vector<unsigned char> &out,
+                          std::span<bool> band = {}) {
+  const std::size_t n = wxs.size();
+  std::vector<float> xs(n), zs(n);
+  const auto noise = [&](float frequency, float offset, float shiftX) {
+    // Same expressions as isOnPath() so results match bit for bit
+    for (std::size_t i = 0; i < n; ++i) {
+      xs[i] = (wxs[i] + shiftX) * frequency + offset;
+      zs[i] = wzs[i] * frequency + offset;
+    }
+    std::vector<float> result(n);
+    db::perlin_batch(xs.data(), zs.data(), result.data(), n);
+    return result;
+  };
+
+  const PathShape &s = pathShape;
+  const std::vector<float> pathNoise1 = noise(s.frequency1, s.offset1, 0.0f);
+  const std::vector<float> pathNoise2 = noise(s.frequency2, s.offset2, 0.0f);
+  const std::vector<float> slope1 = noise(s.slopeFrequency, 0.0f, 0.0f);
+  const std::vector<float> slope2 = noise(s.slopeFrequency, 0.0f, s.slopeStep);
+  const std::vector<float> secondary = noise(s.secondaryFrequency, s.secondaryOffset, 0.0f);
+
+  out.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const float pathValue = std::abs(pathNoise1[i]) + std::abs(pathNoise2[i]) * s.weight2;
+    const bool inSecondary = std::abs(secondary[i]) < s.secondaryThreshold;
+    if (pathValue < s.threshold) {
+      out[i] = std::abs(slope2[i] * s.slopeScale - slope1[i] * s.slopeScale) < s.maxSlope;
+    } else {
+      out[i] = inSecondary;
+    }
+    if (!band.empty()) {
+      band[i] = pathValue < s.threshold || inSecondary;
+    }
+  }
+}
+
+[[nodiscard]] static PathTile *buildPathTile(int tx, int tz) {
+  const int x0 = pathFieldOrigin + tx * pathTileSize;
+  const int z0 = pathFieldOrigin + tz * pathTileSize;
+
+  // Path mask on a half-unit lattice starting 1.5 units before the tile:
+  // 0 = not evaluated, 1 = on path, 2 = off path
+  std::vector<unsigned char> mask(pathLatticeSize * pathLatticeSize, 0);
+  const auto latticeIndex = [](int i, int j) {
+    return (pathNeighbourCells + j * 2) * pathLatticeSize + pathNeighbourCells + i * 2;
+  };
+
+  auto *tile = new PathTile{};
+  std::vector<float> wxs, wzs;
+  std::vector<int> cells;
+  std::vector<unsigned char> onPath;
+  const auto evaluateQueued = [&](std::span<bool> band) {
+    isOnPathBatch(wxs, wzs, onPath, band);
+    for (std::size_t k = 0; k < cells.size(); ++k) {
+      mask[cells[k]] = onPath[k] ? 1 : 2;
+    }
+    wxs.clear();
+    wzs.clear();
+    cells.clear();
+  };
+
+  // Pass 1: the tile's own lattice points
+  for (int j = 0; j < pathTileSize; ++j) {
+    for (int i = 0; i < pathTileSize; ++i) {
+      wxs.push_back(static_cast<float>(x0 + i));
+      wzs.push_back(static_cast<float>(z0 + j));
+      cells.push_back(latticeIndex(i, j));
+    }
+  }
+  evaluateQueued(tile->band);
+
+  // Pass 2: the 1.5-unit neighbours, but only around points on a path
+  for (int j = 0; j < pathTileSize; ++j) {
+    for (int i = 0; i < pathTileSize; ++i) {
+      const int center = latticeIndex(i, j);
+      if (mask[center] != 1) {
+        continue;
+      }
+      for (int dj = -pathNeighbourCells; dj <= pathNeighbourCells; dj += pathNeighbourCells) {
+        for (int di = -pathNeighbourCells; di <= pathNeighbourCells; di += pathNeighbourCells) {
+          const int cell = center + dj * pathLatticeSize + di;
+          if (mask[cell] != 0) {
+            continue;
+          }
+          mask[cell] = 2; // Placeholder so it is queued once
+          wxs.push_back(static_cast<float>(x0 + i) + static_cast<float>(di) * 0.5f);
+          wzs.push_back(static_cast<float>(z0 + j) + static_cast<float>(dj) * 0.5f);
+          cells.push_back(cell);
+        }
+      }
+    }
+  }
+  evaluateQueued({});
+
+  for (int j = 0; j < pathTileSize; ++j) {
+    for (int i = 0; i < pathTileSize; ++i) {
+      const int center = latticeIndex(i, j);
+      if (mask[center] != 1) {
+        continue;
+      }
+
+      int offPath = 0;
+      for (int dj = -pathNeighbourCells; dj <= pathNeighbourCells; dj += pathNeighbourCells) {
+        for (int di = -pathNeighbourCells; di <= pathNeighbourCells; di += pathNeighbourCells) {
+          if ((di != 0 || dj != 0) && mask[center + dj * pathLatticeSize + di] != 1) {
+            ++offPath;
+          }
+        }
+      }
+      tile->codes[j * pathTileSize + i] = static_cast<unsigned char>(1 + offPath);
+    }
+  }
+
+  stampAuthoredPaths(*tile, x0, z0);
+  return tile;
+}
+
+// The tile holding an integer world position, built on first use; null
+// outside the field. cell is the position's index in the tile.
+[[nodiscard]] static const PathTile *pathTileAt(int ix, int iz, int &cell) {
+  const int fx = ix - pathFieldOrigin;
+  const int fz = iz - pathFieldOrigin;
+  constexpr int extent = pathFieldTiles * pathTileSize;
+  if (fx < 0 || fz < 0 || fx >= extent || fz >= extent) {
+    return nullptr;
+  }
+
+  const int tx = fx / pathTileSize;
+  const int tz = fz / pathTileSize;
+  std::atomic<PathTile *> &slot = pathTiles[tz * pathFieldTiles + tx];
+
+  PathTile *tile = slot.load(std::memory_order_acquire);
+  if (tile == nullptr) {
+    // Lock-free: if two workers race on a tile, the loser drops its copy
+    PathTile *built = buildPathTile(tx, tz);
+    if (slot.compare_exchange_strong(tile, built, std::memory_order_acq_rel)) {
+      tile = built;
+      ++builtPathTiles;
+    } else {
+      delete built;
+    }
+  }
+
+  cell = (fz % pathTileSize) * pathTileSize + fx % pathTileSize;
+  return tile;
+}
+
+// Influence at an integer world position
+[[nodiscard]] static float pathInfluenceAt(int ix, int iz) {
+  int cell = 0;
+  const PathTile *tile = pathTileAt(ix, iz, cell);
+  if (tile == nullptr) {
+    return evaluatePathInfluence(static_cast<float>(ix), static_cast<float>(iz));
+  }
+  return pathCodeValues[tile->codes[static_cast<std::size_t>(cell)]];
+}
+
+bool isInPathBand(float wx, float wz) {
+  const int ix = static_cast<int>(std::lround(wx));
+  const int iz = static_cast<int>(std::lround(wz));
+  int cell = 0;
+  const PathTile *tile = pathTileAt(ix, iz, cell);
+  if (tile == nullptr) {
+    return isOnPathIgnoringSlope(static_cast<float>(ix), static_cast<float>(iz));
+  }
+  return tile->band[static_cast<std::size_t>(cell)];
+}
+
+float getPathInfluence(float wx, float wz) {
+  const float fx = std::floor(wx);
+  const float fz = std::floor(wz);
+  const int x0 = static_cast<int>(fx);
+  const int z0 = static_cast<int>(fz);
+  const float tx = wx - fx;
+  const float tz = wz - fz;
+
+  // Chunk vertices sit exactly on the lattice
+  if (tx == 0.0f && tz == 0.0f) {
+    return pathInfluenceAt(x0, z0);
+  }
+
+  const float p00 = pathInfluenceAt(x0, z0);
+  const float p10 = pathInfluenceAt(x0 + 1, z0);
+  const float p01 = pathInfluenceAt(x0, z0 + 1);
+  const float p11 = pathInfluenceAt(x0 + 1, z0 + 1);
+
+  const float p0 = p00 * (1.0f - tx) + p10 * tx;
+  const float p1 = p01 * (1.0f - tx) + p11 * tx;
+  return p0 * (1.0f - tz) + p1 * tz;
+}
+
+void AddAuthoredPath(const Path &path) {
+  // Must be called before chunk workers start sampling the field, and
+  // followed by RefreshBakedWorldHash() if the baked world is open
+  authoredPaths.push_back(path);
+
+  float minX = path.points.empty() ? 0.0f : path.points.front().x;
+  float maxX = minX;
+  float minZ = path.points.empty() ? 0.0f : path.points.front().z;
+  float maxZ = minZ;
+  for (const Vector3 &p : path.points) {
+    minX = std::min(minX, p.x);
+    maxX = std::max(maxX, p.x);
+    minZ = std::min(minZ, p.z);
+    maxZ = std::max(maxZ, p.z);
+  }
+
+  // Drop tiles the path touches so they are rebuilt with it
+  const float margin = path.width * 0.5f + 1.0f;
+  const auto tileOf = [](float w) {
+    return static_cast<int>(std::floor((w - static_cast<float>(pathFieldOrigin)) /
+                                       static_cast<float>(pathTileSize)));
+  };
+  const int tx0 = std::max(0, tileOf(minX - margin));
+  const int tx1 = std::min(pathFieldTiles - 1, tileOf(maxX + margin));
+  const int tz0 = std::max(0, tileOf(minZ - margin));
+  const int tz1 = std::min(pathFieldTiles - 1, tileOf(maxZ + margin));
+  for (int tz = tz0; tz <= tz1; ++tz) {
+    for (int tx = tx0; tx <= tx1; ++tx) {
+      if (PathTile *tile = pathTiles[tz * pathFieldTiles + tx].exchange(nullptr)) {
+        delete tile;
+        --builtPathTiles;
+      }
+    }
+  }
+}
+
+int GetPathFieldTileCount() { return builtPathTiles.load(); }
+
+std::span<const Path> GetAuthoredPaths() { return authoredPaths; }
+
+void UnloadPathField() {
+  for (auto &slot : pathTiles) {
+    delete slot.exchange(nullptr);
+  }
+  builtPathTiles = 0;
+  authoredPaths.clear();
+  std::cout << "Path field unloaded" << std::endl;
+}
@@ -91,6 +91,8 @@ void UpdatePlayer(float deltaTime) {
     camera.position.x += moveDir.x * currentSpeed * deltaTime;
     camera.position.z += moveDir.z * currentSpeed * deltaTime;
   }
+  playerVelocity.x = isMoving ? moveDir.x * currentSpeed : 0.0f;
+  playerVelocity.z = isMoving ? moveDir.z * currentSpeed : 0.0f;
 
   // Smooth velocity for procedural effects
   const float targetVelocity = isMoving ? currentSpeed : 0.0f;
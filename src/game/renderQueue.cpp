@@ -0,0 +1,139 @@
+#include "../core/gpuTimer.h"
+#include "../core/profiler.h"
+#include "game.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// The 3D pass as a list of draw items, one per subsystem batch (the terrain
+// multi-draw, the instanced vegetation, ...). Each carries a 64-bit key:
+//
+//   pass (8) | quantized depth (16) | shader (16) | material (16)
+//
+// so sorting the keys puts the passes in order, opaque items front to back
+// (the early depth test then rejects what they hide), transparent ones back
+// to front, and equal depths grouped by state. The sky goes between the
+// two: at the far plane with the depth test on, it only shades the pixels
+// nothing opaque covered.
+//
+// Ordering is per batch, not per chunk or instance: an item's depth is the
+// distance to the nearest thing it draws, and each batch orders its own
+// chunks. So a batch that only starts far away (water across a valley,
+// vegetation past a bare hilltop) goes after the ones drawing near the
+// camera, but two batches that overlap in depth aren't interleaved.
+//
+// With frontToBack off, the opaque pass runs back to front and the sky
+// first, as it used to, for comparing GPU time and overdraw.
+
+struct RenderItem {
+  std::uint64_t key;
+  RenderPass pass;
+  const char *name;
+  std::function<void()> draw;
+};
+
+constexpr int overdrawSampleFrames = 30; // The readback is slow; not every frame
+constexpr float overdrawLayerValue = 8.0f; // Red per shaded fragment; fragment.glsl adds 1/32
+
+static std::vector<RenderItem> items;
+static std::array<GpuTimer, 3> passTimers; // Per RenderPass
+static RenderQueueStats queueStats{};
+static int overdrawFrame = 0;
+
+static int passOrder(RenderPass pass) {
+  if (pass == RenderPass::Sky) {
+    return frontToBack ? 1 : 0;
+  }
+  return pass == RenderPass::Opaque ? (frontToBack ? 0 : 1) : 2;
+}
+
+void SubmitRenderItem(RenderPass pass, float depth, unsigned int shader, unsigned int material,
+                      const char *name, std::function<void()> draw) {
+  const float normalised = std::clamp(depth / fog.end, 0.0f, 1.0f);
+  auto quantized = static_cast<std::uint64_t>(normalised * 65535.0f);
+  const bool farFirst =
+      pass == RenderPass::Transparent || (pass == RenderPass::Opaque && !frontToBack);
+  if (farFirst) {
+    quantized = 65535 - quantized;
+  }
+  const std::uint64_t key = static_cast<std::uint64_t>(passOrder(pass)) << 48 | quantized << 32 |
+                            static_cast<std::uint64_t>(shader & 0xFFFF) << 16 |
+                            (material & 0xFFFF);
+  items.push_back({key, pass, name, std::move(draw)});
+}
+
+// Mean shaded fragments per pixel, from the additive overdraw colour
+static float measureOverdraw() {
+  rlDrawRenderBatchActive();
+  Image screen = LoadImageFromScreen();
+  const auto *pixels = static_cast<const unsigned char *>(screen.data);
+  const std::size_t count = static_cast<std::size_t>(screen.width) * screen.height;
+  double sum = 0.0;
+  for (std::size_t i = 0; i < count; ++i) {
+    sum += pixels[i * 4];
+  }
+  UnloadImage(screen);
+  return count != 0 ? static_cast<float>(sum / static_cast<double>(count) / overdrawLayerValue)
+                    : 0.0f;
+}
+
+void FlushRenderQueue() {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  const ProfileScope flushScope("render queue");
+
+  // Stable, so items with equal keys keep the order they were submitted in
+  std::stable_sort(items.begin(), items.end(),
+                   [](const RenderItem &a, const RenderItem &b) { return a.key < b.key; });
+  const float sortMicroseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+
+  const float overdraw = queueStats.overdraw;
+  queueStats = {};
+  queueStats.items = static_cast<int>(items.size());
+  queueStats.sortMicroseconds = sortMicroseconds;
+  queueStats.overdraw = overdrawView ? overdraw : 0.0f;
+
+  if (overdrawView) {
+    // Every shaded fragment adds up, including those drawn over later
+    BeginBlendMode(BLEND_ADDITIVE);
+  }
+  std::size_t i = 0;
+  while (i < items.size()) {
+    const RenderPass pass = items[i].pass;
+    GpuTimer &timer = passTimers[static_cast<std::size_t>(pass)];
+    timer.begin();
+    for (; i < items.size() && items[i].pass == pass; ++i) {
+      // The sky would only cover up the count
+      if (!(overdrawView && pass == RenderPass::Sky)) {
+        const ProfileScope scope(items[i].name);
+        items[i].draw();
+      }
+    }
+    timer.end();
+  }
+  if (overdrawView) {
+    EndBlendMode();
+    if (overdrawFrame++ % overdrawSampleFrames == 0) {
+      queueStats.overdraw = measureOverdraw();
+    }
+  }
+  items.clear();
+
+  constexpr std::array<const char *, 3> gpuCounters = {"GPU opaque ms", "GPU sky ms",
+                                                        "GPU transparent ms"};
+  for (std::size_t pass = 0; pass < passTimers.size(); ++pass) {
+    queueStats.gpuMilliseconds[pass] = passTimers[pass].milliseconds();
+    RecordProfilerCounter(gpuCounters[pass], queueStats.gpuMilliseconds[pass]);
+  }
+}
+
+RenderQueueStats GetRenderQueueStats() { return queueStats; }
+
+void ReleaseRenderQueue() {
+  for (GpuTimer &timer : passTimers) {
+    timer.release();
+  }
+  items.clear();
+}
@@ -1,125 +1,176 @@
 #include "game.h"
-#include <algorithm>
+#include "raymath.h"
+#include "rlgl.h"
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <numbers>
 #include <random>
-#include <vector>
 
-struct Star {
-  Vector3 position;
-  float brightness;
-  float size;
-};
+// The sky is two static meshes built once: a gradient dome and a quad per
+// star. Both are centred on the eye by dropping the view translation in
+// their vertex shaders, so each frame is two draw calls with nothing rebuilt
+// on the CPU. They sit just inside the far plane and are drawn after the
+// opaque geometry with the depth test on, so only uncovered pixels shade.
+
+constexpr Color skyColorTop = {20, 15, 18, 255};
+constexpr int domeRings = 16;    // Zenith to horizon
+constexpr int domeSegments = 32; // Around
+constexpr float domeRadius = 400.0f;
+constexpr int starCount = 400;
+constexpr float starRadius = 500.0f;
+
+static Mesh domeMesh{};
+static Mesh starMesh{};
+static Material domeMaterial{};
+static Material starMaterial{};
+static SkyStats skyStats{};
+
+static Mesh buildDomeMesh() {
+  using std::numbers::pi_v;
+
+  Mesh mesh{};
+  mesh.vertexCount = (domeRings + 1) * domeSegments;
+  mesh.triangleCount = domeRings * domeSegments * 2;
+  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(mesh.triangleCount * 3 * sizeof(unsigned short))));
+
+  int v = 0;
+  for (int i = 0; i <= domeRings; ++i) {
+    const float angle = static_cast<float>(i) / domeRings * pi_v<float> / 2.0f;
+    for (int j = 0; j < domeSegments; ++j) {
+      const float theta = static_cast<float>(j) / domeSegments * 2.0f * pi_v<float>;
+      mesh.vertices[v++] = domeRadius * std::sin(angle) * std::cos(theta);
+      mesh.vertices[v++] = domeRadius * std::cos(angle);
+      mesh.vertices[v++] = domeRadius * std::sin(angle) * std::sin(theta);
+    }
+  }
 
-std::vector<Star> stars;
+  int index = 0;
+  for (int i = 0; i < domeRings; ++i) {
+    for (int j = 0; j < domeSegments; ++j) {
+      const int next = (j + 1) % domeSegments;
+      const auto p1 = static_cast<unsigned short>(i * domeSegments + j);
+      const auto p2 = static_cast<unsigned short>(i * domeSegments + next);
+      const auto p3 = static_cast<unsigned short>((i + 1) * domeSegments + next);
+      const auto p4 = static_cast<unsigned short>((i + 1) * domeSegments + j);
+      for (const unsigned short corner : {p1, p2, p3, p1, p3, p4}) {
+        mesh.indices[index++] = corner;
+      }
+    }
+  }
 
-void GenerateStars() {
-  stars.clear();
-  stars.reserve(400);
-  
+  UploadMesh(&mesh, false);
+  return mesh;
+}
+
+// Four vertices per star at its position on the sphere. texcoords hold the
+// quad corner, texcoords2 brightness and size; the vertex shader expands the
+// corners to a camera-facing quad.
+static Mesh buildStarMesh() {
   std::random_device rd;
   std::mt19937 gen(rd());
   std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 
   using std::numbers::pi_v;
-  constexpr float radius = 500.0f;
-  
-  for (int i = 0; i < 400; ++i) {
-    Star star;
 
+  Mesh mesh{};
+  mesh.vertexCount = starCount * 4;
+  mesh.triangleCount = starCount * 2;
+  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.texcoords = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * sizeof(float))));
+  mesh.texcoords2 = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * sizeof(float))));
+  mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(mesh.triangleCount * 3 * sizeof(unsigned short))));
+
+  constexpr float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+  for (int i = 0; i < starCount; ++i) {
     const float theta = dist(gen) * 2.0f * pi_v<float>;
     const float phi = dist(gen) * pi_v<float>;
+    const Vector3 position = {starRadius * std::sin(phi) * std::cos(theta),
+                              starRadius * std::cos(phi),
+                              starRadius * std::sin(phi) * std::sin(theta)};
+    const float brightness = 0.3f + dist(gen) * 0.7f;
+    const float size = 1.0f + dist(gen) * 2.0f;
+
+    for (int c = 0; c < 4; ++c) {
+      const int v = i * 4 + c;
+      mesh.vertices[v * 3 + 0] = position.x;
+      mesh.vertices[v * 3 + 1] = position.y;
+      mesh.vertices[v * 3 + 2] = position.z;
+      mesh.texcoords[v * 2 + 0] = corners[c][0];
+      mesh.texcoords[v * 2 + 1] = corners[c][1];
+      mesh.texcoords2[v * 2 + 0] = brightness;
+      mesh.texcoords2[v * 2 + 1] = size;
+    }
 
-    star.position.x = radius * std::sin(phi) * std::cos(theta);
-    star.position.y = radius * std::cos(phi);
-    star.position.z = radius * std::sin(phi) * std::sin(theta);
+    const auto first = static_cast<unsigned short>(i * 4);
+    const int index = i * 6;
+    mesh.indices[index + 0] = first;
+    mesh.indices[index + 1] = static_cast<unsigned short>(first + 1);
+    mesh.indices[index + 2] = static_cast<unsigned short>(first + 2);
+    mesh.indices[index + 3] = first;
+    mesh.indices[index + 4] = static_cast<unsigned short>(first + 2);
+    mesh.indices[index + 5] = static_cast<unsigned short>(first + 3);
+  }
 
-    star.brightness = 0.3f + dist(gen) * 0.7f;
-    star.size = 1.0f + dist(gen) * 2.0f;
+  UploadMesh(&mesh, false);
+  return mesh;
+}
 
-    stars.push_back(star);
+static Material loadSkyMaterial(const char *vertexPath, const char *fragmentPath) {
+  Material material = LoadMaterialDefault();
+  material.shader = LoadShader(vertexPath, fragmentPath);
+  if (material.shader.id == 0) {
+    std::cout << "ERROR: Sky shader " << vertexPath << " failed to load!" << std::endl;
+    return material;
   }
 
-  std::cout << "Generated " << stars.size() << " stars" << std::endl;
+  const Vector3 top = {skyColorTop.r / 255.0f, skyColorTop.g / 255.0f,
+                       skyColorTop.b / 255.0f};
+  const Vector3 horizon = {skyColorHorizon.r / 255.0f, skyColorHorizon.g / 255.0f,
+                           skyColorHorizon.b / 255.0f};
+  SetShaderValue(material.shader, GetShaderLocation(material.shader, "skyTop"),
+                 &top, SHADER_UNIFORM_VEC3);
+  SetShaderValue(material.shader, GetShaderLocation(material.shader, "skyHorizon"),
+                 &horizon, SHADER_UNIFORM_VEC3);
+  return material;
 }
 
-void DrawSky(Camera camera) {
-  constexpr Color fogColor = {115, 102, 97, 255};
-  constexpr Color skyColorTop = {20, 15, 18, 255};
-  constexpr Color skyColorHorizon = fogColor;
+void InitSky() {
+  domeMesh = buildDomeMesh();
+  starMesh = buildStarMesh();
+  domeMaterial = loadSkyMaterial("src/shaders/skybox.vs", "src/shaders/skybox.fs");
+  starMaterial = loadSkyMaterial("src/shaders/stars.vs", "src/shaders/stars.fs");
 
-  const Vector3 skyCenter = camera.position;
+  std::cout << "Generated sky dome and " << starCount << " stars" << std::endl;
+}
 
-  constexpr int segments = 16;
-  constexpr float skyRadius = 400.0f;
+void DrawSky() {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
 
-  using std::numbers::pi_v;
-  
-  for (int i = 0; i < segments; ++i) {
-    const float angle1 = static_cast<float>(i) / segments * pi_v<float> / 2.0f;
-    const float angle2 = static_cast<float>(i + 1) / segments * pi_v<float> / 2.0f;
-
-    const float y1 = skyRadius * std::cos(angle1);
-    const float y2 = skyRadius * std::cos(angle2);
-    const float r1 = skyRadius * std::sin(angle1);
-    const float r2 = skyRadius * std::sin(angle2);
-
-    const float t1 = static_cast<float>(i) / segments;
-    const float t2 = static_cast<float>(i + 1) / segments;
-
-    const Color color1 = {
-        static_cast<unsigned char>(skyColorTop.r * (1 - t1) + skyColorHorizon.r * t1),
-        static_cast<unsigned char>(skyColorTop.g * (1 - t1) + skyColorHorizon.g * t1),
-        static_cast<unsigned char>(skyColorTop.b * (1 - t1) + skyColorHorizon.b * t1),
-        255};
-
-    const Color color2 = {
-        static_cast<unsigned char>(skyColorTop.r * (1 - t2) + skyColorHorizon.r * t2),
-        static_cast<unsigned char>(skyColorTop.g * (1 - t2) + skyColorHorizon.g * t2),
-        static_cast<unsigned char>(skyColorTop.b * (1 - t2) + skyColorHorizon.b * t2),
-        255};
-
-    for (int j = 0; j < 32; ++j) {
-      const float theta1 = static_cast<float>(j) / 32 * 2.0f * pi_v<float>;
-      const float theta2 = static_cast<float>(j + 1) / 32 * 2.0f * pi_v<float>;
-
-      const Vector3 p1 = {skyCenter.x + r1 * std::cos(theta1), skyCenter.y + y1,
-                          skyCenter.z + r1 * std::sin(theta1)};
-      const Vector3 p2 = {skyCenter.x + r1 * std::cos(theta2), skyCenter.y + y1,
-                          skyCenter.z + r1 * std::sin(theta2)};
-      const Vector3 p3 = {skyCenter.x + r2 * std::cos(theta2), skyCenter.y + y2,
-                          skyCenter.z + r2 * std::sin(theta2)};
-      const Vector3 p4 = {skyCenter.x + r2 * std::cos(theta1), skyCenter.y + y2,
-                          skyCenter.z + r2 * std::sin(theta1)};
-
-      DrawTriangle3D(p1, p2, p3, color1);
-      DrawTriangle3D(p1, p3, p4, color2);
-    }
-  }
+  // Behind everything, and seen from inside
+  rlDisableDepthMask();
+  rlDisableBackfaceCulling();
 
-  // Draw stars with fog fade
-  for (const auto &star : stars) {
-    const Vector3 starPos = {camera.position.x + star.position.x,
-                             camera.position.y + star.position.y,
-                             camera.position.z + star.position.z};
-
-    const float dist = Vector3Distance(camera.position, starPos);
-    constexpr float fogStart = 15.0f;
-    const float fogFactor = std::clamp(1.0f - std::exp(-0.04f * std::max(0.0f, dist - fogStart)),
-                                       0.0f, 1.0f);
-
-    const float starAlpha = star.brightness * (1.0f - fogFactor);
-
-    if (starAlpha > 0.1f) {
-      const Color starColor = {
-          static_cast<unsigned char>(255 * starAlpha), 
-          static_cast<unsigned char>(240 * starAlpha),
-          static_cast<unsigned char>(220 * starAlpha), 
-          static_cast<unsigned char>(255 * starAlpha)};
-      DrawSphere(starPos, star.size, starColor);
-    }
-  }
+  DrawMesh(domeMesh, domeMaterial, MatrixIdentity());
+  DrawMesh(starMesh, starMaterial, MatrixIdentity());
+
+  rlEnableBackfaceCulling();
+  rlEnableDepthMask();
+
+  skyStats.drawCalls = 2;
+  skyStats.microseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
 }
 
-void CleanupSky() { stars.clear(); }
+SkyStats GetSkyStats() { return skyStats; }
+
+void CleanupSky() {
+  UnloadMesh(domeMesh);
+  UnloadMesh(starMesh);
+  UnloadMaterial(domeMaterial);
+  UnloadMaterial(starMaterial);
+  domeMesh = {};
+  starMesh = {};
+}
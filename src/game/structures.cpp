@@ -1,4 +1,5 @@
 #include "game.h"
+#include <algorithm>
 #include <iostream>
 
 extern Shader lightingShader;
@@ -24,7 +25,16 @@ void initializeSpawnHut() {
   hutModel = LoadModelFromMesh(hutMesh);
   hutModel.materials[0].shader = lightingShader; // Apply fog shader
 
-  constexpr float terrainHeight = 15.0f; // Approximate
+  // Rest on the lowest corner so no side of the floor hangs in the air
+  const float halfX = spawnHut.size.x / 2.0f;
+  const float halfZ = spawnHut.size.z / 2.0f;
+  float terrainHeight = getTerrainHeight(spawnHut.position.x, spawnHut.position.z);
+  for (const float dx : {-halfX, halfX}) {
+    for (const float dz : {-halfZ, halfZ}) {
+      terrainHeight = std::min(terrainHeight, getTerrainHeight(spawnHut.position.x + dx,
+                                                               spawnHut.position.z + dz));
+    }
+  }
   spawnHut.position.y = terrainHeight + spawnHut.size.y / 2.0f;
 
   std::cout << "Spawn hut placed at: " << spawnHut.position.x << ", "
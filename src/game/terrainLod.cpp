@@ -0,0 +1,248 @@
+#include "game.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Adaptive terrain triangulation. A quadtree over the 31x31 cells is split
+// until each leaf's coarse fan (centre to the four corners) is within the
+// level's tolerances of the heights and colours it covers. Every leaf then fans from its centre through all
+// vertices on its perimeter that are used by any leaf, so adjacent leaves of
+// different sizes share their edge vertices and no T-junctions appear. Chunk
+// border vertices are always used, which keeps seams between chunks at
+// different LODs crack-free.
+
+namespace {
+
+constexpr int chunkSize = 32;
+constexpr int stride = chunkSize - 1;
+
+struct Node {
+  int x0, z0, x1, z1; // Vertex bounds, inclusive
+};
+
+[[nodiscard]] constexpr bool isFanLeaf(const Node &node) noexcept {
+  // A fan needs a centre strictly inside the node
+  return node.x1 - node.x0 >= 2 && node.z1 - node.z0 >= 2;
+}
+
+// Barycentric weights of (x, z) in triangle (a, b, c); false if outside
+[[nodiscard]] bool barycentric(float x, float z, const Vector2 &a,
+                               const Vector2 &b, const Vector2 &c,
+                               Vector3 &weights) noexcept {
+  const float det = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+  weights.x = ((b.y - c.y) * (x - c.x) + (c.x - b.x) * (z - c.y)) / det;
+  weights.y = ((c.y - a.y) * (x - c.x) + (a.x - c.x) * (z - c.y)) / det;
+  weights.z = 1.0f - weights.x - weights.y;
+  constexpr float eps = -1e-4f;
+  return weights.x >= eps && weights.y >= eps && weights.z >= eps;
+}
+
+// How far the node's coarse fan is from the real surface, as a fraction of
+// the level's tolerances (<= 1 means the fan is good enough). Colour counts
+// too, so paths and height bands don't smear across large triangles.
+[[nodiscard]] float fanError(const Node &node, const TerrainSurface &surface,
+                             const TerrainLodLevel &level) {
+  const std::array<int, 5> fan = {
+      ((node.z0 + node.z1) / 2) * chunkSize + (node.x0 + node.x1) / 2,
+      node.z0 * chunkSize + node.x0, node.z0 * chunkSize + node.x1,
+      node.z1 * chunkSize + node.x1, node.z1 * chunkSize + node.x0};
+  std::array<Vector2, 5> points;
+  for (std::size_t i = 0; i < fan.size(); ++i) {
+    points[i] = {static_cast<float>(fan[i] % chunkSize),
+                 static_cast<float>(fan[i] / chunkSize)};
+  }
+
+  float heightError = 0.0f;
+  float colorError = 0.0f;
+  for (int z = node.z0; z <= node.z1; ++z) {
+    for (int x = node.x0; x <= node.x1; ++x) {
+      const int idx = z * chunkSize + x;
+      for (std::size_t i = 1; i < fan.size(); ++i) {
+        const std::size_t j = i % 4 + 1;
+        Vector3 w;
+        if (!barycentric(static_cast<float>(x), static_cast<float>(z),
+                         points[0], points[i], points[j], w)) {
+          continue;
+        }
+
+        const float h = w.x * surface.heights[fan[0]] +
+                        w.y * surface.heights[fan[i]] +
+                        w.z * surface.heights[fan[j]];
+        heightError = std::max(heightError, std::abs(h - surface.heights[idx]));
+        for (int c = 0; c < 3; ++c) {
+          const float color = w.x * surface.colors[fan[0] * 4 + c] +
+                              w.y * surface.colors[fan[i] * 4 + c] +
+                              w.z * surface.colors[fan[j] * 4 + c];
+          colorError = std::max(
+              colorError, std::abs(color - surface.colors[idx * 4 + c]));
+        }
+        break;
+      }
+    }
+  }
+  return std::max(heightError / level.maxError,
+                  colorError / level.maxColorError);
+}
+
+void collectLeaves(const Node &node, const TerrainSurface &surface,
+                   const TerrainLodLevel &level, std::vector<Node> &leaves) {
+  if (!isFanLeaf(node) || fanError(node, surface, level) <= 1.0f) {
+    leaves.push_back(node);
+    return;
+  }
+
+  // Split at the midpoint. 31 cells don't halve evenly, so some children end
+  // up one cell wide; those are emitted as plain grid cells.
+  const int mx = (node.x0 + node.x1) / 2;
+  const int mz = (node.z0 + node.z1) / 2;
+  collectLeaves({node.x0, node.z0, mx, mz}, surface, level, leaves);
+  collectLeaves({mx, node.z0, node.x1, mz}, surface, level, leaves);
+  collectLeaves({node.x0, mz, mx, node.z1}, surface, level, leaves);
+  collectLeaves({mx, mz, node.x1, node.z1}, surface, level, leaves);
+}
+
+} // namespace
+
+std::vector<unsigned short> triangulateTerrain(const TerrainSurface &surface,
+                                               const TerrainLodLevel &level) {
+  std::vector<Node> leaves;
+  collectLeaves({0, 0, stride, stride}, surface, level, leaves);
+
+  // Mark every vertex some leaf uses on its boundary
+  std::vector<bool> used(chunkSize * chunkSize, false);
+  for (int i = 0; i < chunkSize; ++i) {
+    used[i] = used[stride * chunkSize + i] = true;
+    used[i * chunkSize] = used[i * chunkSize + stride] = true;
+  }
+  for (const Node &node : leaves) {
+    if (isFanLeaf(node)) {
+      used[node.z0 * chunkSize + node.x0] = used[node.z0 * chunkSize + node.x1] = true;
+      used[node.z1 * chunkSize + node.x0] = used[node.z1 * chunkSize + node.x1] = true;
+    } else {
+      for (int z = node.z0; z <= node.z1; ++z) {
+        for (int x = node.x0; x <= node.x1; ++x) {
+          used[z * chunkSize + x] = true;
+        }
+      }
+    }
+  }
+
+  std::vector<unsigned short> indices;
+  const auto index = [](int x, int z) {
+    return static_cast<unsigned short>(z * chunkSize + x);
+  };
+
+  std::vector<unsigned short> perimeter;
+  for (const Node &node : leaves) {
+    if (!isFanLeaf(node)) {
+      // Same winding as the full-resolution grid
+      for (int z = node.z0; z < node.z1; ++z) {
+        for (int x = node.x0; x < node.x1; ++x) {
+          indices.insert(indices.end(),
+                         {index(x, z), index(x, z + 1), index(x + 1, z),
+                          index(x + 1, z), index(x, z + 1), index(x + 1, z + 1)});
+        }
+      }
+      continue;
+    }
+
+    // Walk the perimeter: top, right, bottom, left
+    perimeter.clear();
+    const auto visit = [&](int x, int z) {
+      if (used[z * chunkSize + x]) {
+        perimeter.push_back(index(x, z));
+      }
+    };
+    for (int x = node.x0; x < node.x1; ++x) {
+      visit(x, node.z0);
+    }
+    for (int z = node.z0; z < node.z1; ++z) {
+      visit(node.x1, z);
+    }
+    for (int x = node.x1; x > node.x0; --x) {
+      visit(x, node.z1);
+    }
+    for (int z = node.z1; z > node.z0; --z) {
+      visit(node.x0, z);
+    }
+
+    const unsigned short centre =
+        index((node.x0 + node.x1) / 2, (node.z0 + node.z1) / 2);
+    for (std::size_t i = 0; i < perimeter.size(); ++i) {
+      // The walk runs the opposite way round to the grid's winding
+      indices.insert(indices.end(),
+                     {centre, perimeter[(i + 1) % perimeter.size()], perimeter[i]});
+    }
+  }
+
+  return indices;
+}
+
+Mesh buildTerrainLodMesh(const Mesh &full, std::span<const unsigned short> indices) {
+  // Keep only the vertices this level references, in first-use order. The
+  // quadtree emits triangles leaf by leaf, which is already cache-friendly
+  // enough (ACMR ~0.8) that OptimizeVertexCache() isn't worth its cost here.
+  std::vector<int> remap(static_cast<std::size_t>(full.vertexCount), -1);
+  int vertexCount = 0;
+  for (const unsigned short i : indices) {
+    if (remap[i] < 0) {
+      remap[i] = vertexCount++;
+    }
+  }
+
+  Mesh mesh{};
+  mesh.vertexCount = vertexCount;
+  mesh.triangleCount = static_cast<int>(indices.size() / 3);
+  mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.texcoords = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * sizeof(float))));
+  mesh.normals = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+  mesh.colors = static_cast<unsigned char*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 4 * sizeof(unsigned char))));
+  mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(indices.size() * sizeof(unsigned short))));
+
+  for (int src = 0; src < full.vertexCount; ++src) {
+    const int dst = remap[static_cast<std::size_t>(src)];
+    if (dst < 0) {
+      continue;
+    }
+    std::memcpy(&mesh.vertices[dst * 3], &full.vertices[src * 3], 3 * sizeof(float));
+    std::memcpy(&mesh.texcoords[dst * 2], &GetTerrainGridTexcoords()[static_cast<std::size_t>(src) * 2], 2 * sizeof(float));
+    std::memcpy(&mesh.normals[dst * 3], &full.normals[src * 3], 3 * sizeof(float));
+    std::memcpy(&mesh.colors[dst * 4], &full.colors[src * 4], 4 * sizeof(unsigned char));
+  }
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    mesh.indices[i] = static_cast<unsigned short>(remap[indices[i]]);
+  }
+
+  return mesh;
+}
+
+int selectTerrainLod(const Chunk &chunk, const Camera &camera) {
+  if (!adaptiveTerrainLod || chunk.meshRanges.size() < 2) {
+    return 0;
+  }
+  const std::size_t levels = chunk.meshRanges.size() - 1; // Uploaded LODs
+
+  // Distance from the camera to the chunk's bounding box
+  const float minX = static_cast<float>(chunk.x * stride);
+  const float minZ = static_cast<float>(chunk.z * stride);
+  const Vector3 &p = camera.position;
+  const float dx = std::max({minX - p.x, 0.0f, p.x - (minX + stride)});
+  const float dy = std::max({chunk.minHeight - p.y, 0.0f, p.y - chunk.maxHeight});
+  const float dz = std::max({minZ - p.z, 0.0f, p.z - (minZ + stride)});
+  const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+  // Pixels per world unit at that distance
+  const float projection = static_cast<float>(GetScreenHeight()) /
+                           (2.0f * std::tan(camera.fovy * DEG2RAD * 0.5f));
+
+  // Coarsest level whose geometric error projects under the pixel tolerance
+  int lod = 0;
+  for (std::size_t i = 0; i < levels; ++i) {
+    if (terrainLodLevels[i].maxError * projection > terrainLodPixelError * distance) {
+      break;
+    }
+    lod = static_cast<int>(i) + 1;
+  }
+  return lod;
+}
@@ -0,0 +1,801 @@
+#include "../core/glExtensions.h"
+#include "game.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <vector>
+
+// GPU side of terrain chunks. Every full-resolution chunk has the same
+// topology, so one copy of the grid indices serves them all; a chunk only
+// uploads positions, normals and colours. With packedTerrainVertices those
+// shrink further to an 8-byte PackedTerrainVertex plus the colour, decoded by
+// vertex.glsl's PACKED_TERRAIN variant. All of it lives in one arena of
+// shared buffers (see TerrainArena).
+
+namespace {
+
+constexpr int chunkSize = 32;
+constexpr int stride = chunkSize - 1;
+constexpr int gridTriangles = stride * stride * 2;
+
+constexpr int glUnsignedShort = 0x1403; // GL_UNSIGNED_SHORT; rlgl.h has no alias
+
+} // namespace
+
+std::vector<unsigned short> BuildTerrainGridIndices() {
+  std::vector<unsigned short> indices;
+  indices.reserve(gridTriangles * 3);
+  for (int z = 0; z < stride; ++z) {
+    for (int x = 0; x < stride; ++x) {
+      const int topLeft = z * chunkSize + x;
+      const int topRight = topLeft + 1;
+      const int bottomLeft = (z + 1) * chunkSize + x;
+      const int bottomRight = bottomLeft + 1;
+
+      indices.insert(indices.end(),
+                     {static_cast<unsigned short>(topLeft),
+                      static_cast<unsigned short>(bottomLeft),
+                      static_cast<unsigned short>(topRight),
+                      static_cast<unsigned short>(topRight),
+                      static_cast<unsigned short>(bottomLeft),
+                      static_cast<unsigned short>(bottomRight)});
+    }
+  }
+  return indices;
+}
+
+namespace {
+
+// Forsyth's linear-speed vertex cache optimisation: greedily emit the
+// triangle whose vertices score best under a simulated LRU cache
+constexpr int forsythCacheSize = 32;
+
+[[nodiscard]] float forsythScore(int cachePosition, int remainingTriangles) noexcept {
+  if (remainingTriangles == 0) {
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    if (cachePosition < 3) {
+      score = 0.75f; // Used by the last triangle; don't favour it too much
+    } else {
+      const float scale = 1.0f / static_cast<float>(forsythCacheSize - 3);
+      score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, 1.5f);
+    }
+  }
+
+  // Boost vertices with few triangles left so they get finished off
+  return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+}
+
+} // namespace
+
+void OptimizeVertexCache(std::span<unsigned short> indices, int vertexCount) {
+  const std::size_t triangleCount = indices.size() / 3;
+  const auto vertices = static_cast<std::size_t>(vertexCount);
+
+  // Triangles using each vertex
+  std::vector<int> remaining(vertices, 0);
+  for (const unsigned short i : indices) {
+    ++remaining[i];
+  }
+  std::vector<std::size_t> offsets(vertices + 1, 0);
+  for (std::size_t v = 0; v < vertices; ++v) {
+    offsets[v + 1] = offsets[v] + static_cast<std::size_t>(remaining[v]);
+  }
+  std::vector<int> vertexTriangles(indices.size());
+  std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+  for (std::size_t t = 0; t < triangleCount; ++t) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      vertexTriangles[fill[indices[t * 3 + k]]++] = static_cast<int>(t);
+    }
+  }
+
+  std::vector<int> cachePosition(vertices, -1);
+  std::vector<float> vertexScore(vertices);
+  for (std::size_t v = 0; v < vertices; ++v) {
+    vertexScore[v] = forsythScore(-1, remaining[v]);
+  }
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<float> triangleScore(triangleCount);
+  const auto scoreTriangle = [&](std::size_t t) {
+    triangleScore[t] = vertexScore[indices[t * 3]] +
+                       vertexScore[indices[t * 3 + 1]] +
+                       vertexScore[indices[t * 3 + 2]];
+  };
+  for (std::size_t t = 0; t < triangleCount; ++t) {
+    scoreTriangle(t);
+  }
+
+  std::vector<unsigned short> output;
+  output.reserve(indices.size());
+  std::vector<unsigned short> cache;
+  cache.reserve(forsythCacheSize + 3);
+
+  std::size_t scan = 0; // Fallback search resumes here
+  for (std::size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+    // Best triangle touching the cache, else the next unemitted one
+    long best = -1;
+    float bestScore = -1.0f;
+    for (const unsigned short v : cache) {
+      for (std::size_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+        const int t = vertexTriangles[i];
+        if (!emitted[static_cast<std::size_t>(t)] &&
+            triangleScore[static_cast<std::size_t>(t)] > bestScore) {
+          best = t;
+          bestScore = triangleScore[static_cast<std::size_t>(t)];
+        }
+      }
+    }
+    if (best < 0) {
+      while (emitted[scan]) {
+        ++scan;
+      }
+      best = static_cast<long>(scan);
+    }
+
+    const auto t = static_cast<std::size_t>(best);
+    emitted[t] = true;
+    for (std::size_t k = 0; k < 3; ++k) {
+      const unsigned short v = indices[t * 3 + k];
+      output.push_back(v);
+      --remaining[v];
+
+      // Move to the front of the cache
+      const auto it = std::find(cache.begin(), cache.end(), v);
+      if (it != cache.end()) {
+        cache.erase(it);
+      }
+      cache.insert(cache.begin(), v);
+    }
+
+    // Rescore what's in (or just fell out of) the cache
+    for (std::size_t i = 0; i < cache.size(); ++i) {
+      const unsigned short v = cache[i];
+      cachePosition[v] = i < forsythCacheSize ? static_cast<int>(i) : -1;
+      vertexScore[v] = forsythScore(cachePosition[v], remaining[v]);
+    }
+    for (const unsigned short v : cache) {
+      for (std::size_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+        if (!emitted[static_cast<std::size_t>(vertexTriangles[i])]) {
+          scoreTriangle(static_cast<std::size_t>(vertexTriangles[i]));
+        }
+      }
+    }
+    if (cache.size() > forsythCacheSize) {
+      cache.resize(forsythCacheSize);
+    }
+  }
+
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+float ComputeACMR(std::span<const unsigned short> indices, int cacheSize) {
+  // Average cache miss ratio against a FIFO post-transform cache
+  std::deque<unsigned short> cache;
+  int misses = 0;
+  for (const unsigned short v : indices) {
+    if (std::find(cache.begin(), cache.end(), v) != cache.end()) {
+      continue;
+    }
+    ++misses;
+    cache.push_back(v);
+    if (static_cast<int>(cache.size()) > cacheSize) {
+      cache.pop_front();
+    }
+  }
+  return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+std::span<const unsigned short> GetTerrainGridIndices() {
+  static const std::vector<unsigned short> indices = [] {
+    std::vector<unsigned short> grid = BuildTerrainGridIndices();
+    OptimizeVertexCache(grid, chunkSize * chunkSize);
+    return grid;
+  }();
+  return indices;
+}
+
+std::span<const float> GetTerrainGridTexcoords() {
+  static const std::vector<float> texcoords = [] {
+    std::vector<float> uv(chunkSize * chunkSize * 2);
+    for (int z = 0; z < chunkSize; ++z) {
+      for (int x = 0; x < chunkSize; ++x) {
+        uv[(z * chunkSize + x) * 2] = static_cast<float>(x) / stride;
+        uv[(z * chunkSize + x) * 2 + 1] = static_cast<float>(z) / stride;
+      }
+    }
+    return uv;
+  }();
+  return texcoords;
+}
+
+Shader LoadTerrainShader(bool packed) {
+  return LoadLightingShader(packed ? "#define TERRAIN_ARENA\n#define PACKED_TERRAIN\n"
+                                   : "#define TERRAIN_ARENA\n");
+}
+
+PackedTerrainVertex PackTerrainVertex(int x, int z, float height,
+                                      Vector3 normal) noexcept {
+  PackedTerrainVertex packed{};
+
+  const float t = std::clamp((height - terrainHeightMin) / terrainHeightRange, 0.0f, 1.0f);
+  packed.height = static_cast<std::uint16_t>(std::lround(t * 65535.0f));
+  packed.x = static_cast<std::uint8_t>(x);
+  packed.z = static_cast<std::uint8_t>(z);
+
+  // Octahedral encoding around +Y, which is where terrain normals cluster
+  const float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  float u = normal.x / l1;
+  float v = normal.z / l1;
+  if (normal.y < 0.0f) {
+    const float foldU = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+    const float foldV = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+    u = foldU;
+    v = foldV;
+  }
+  packed.normal[0] = static_cast<std::uint16_t>(std::lround((u * 0.5f + 0.5f) * 65535.0f));
+  packed.normal[1] = static_cast<std::uint16_t>(std::lround((v * 0.5f + 0.5f) * 65535.0f));
+  return packed;
+}
+
+namespace {
+
+// Terrain arena. Every uploaded terrain mesh, full grid or LOD, is a range
+// of one set of big buffers: its vertices a run of 64-vertex pages, its
+// indices (LODs only; full grids share one copy of the grid's) a run of the
+// index buffer. One VAO covers the lot, so all visible terrain goes out in
+// a single glMultiDrawElementsBaseVertex with one shader binding. Meshes
+// stay chunk-local: the vertex shader looks up its chunk's origin by
+// gl_VertexID's page in a page table texture.
+//
+// Released ranges wait behind a fence before the allocators hand them out
+// again, so nothing the GPU may still be reading is overwritten. The arena
+// doubles (copying on the GPU) when it runs out, and halves again once more
+// than terrainPoolHighWater full-grid meshes' worth of pages sit idle and
+// the top half is free. First-fit keeps live ranges low, so the top half
+// empties as the loaded set shrinks.
+
+constexpr int pageVertices = 64;     // Keep in sync with vertex.glsl
+constexpr int pageTableWidth = 256;  // Texels per page table row, likewise
+constexpr int initialPages = 8192;   // 512k vertices, ~300 chunks with LODs
+constexpr int initialIndices = 1 << 20;
+
+constexpr unsigned int glTriangles = 0x0004; // GL_TRIANGLES
+
+// Without sync objects, assume the driver is at most this many frames behind
+constexpr unsigned long fallbackReleaseFrames = 3;
+
+// First-fit allocator over [0, capacity) units
+class RangeAllocator {
+public:
+  [[nodiscard]] int capacity() const noexcept { return total; }
+  [[nodiscard]] int used() const noexcept { return inUse; }
+  // Units past the last allocated one
+  [[nodiscard]] int freeAtEnd() const noexcept {
+    if (freeRanges.empty()) {
+      return 0;
+    }
+    const auto &[offset, size] = *freeRanges.rbegin();
+    return offset + size == total ? size : 0;
+  }
+
+  void grow(int newCapacity) {
+    addFree(total, newCapacity - total);
+    total = newCapacity;
+  }
+
+  // Only over free units: newCapacity >= capacity() - freeAtEnd()
+  void shrink(int newCapacity) {
+    const auto last = std::prev(freeRanges.end());
+    const int offset = last->first;
+    freeRanges.erase(last);
+    if (offset < newCapacity) {
+      freeRanges.emplace(offset, newCapacity - offset);
+    }
+    total = newCapacity;
+  }
+
+  [[nodiscard]] std::optional<int> allocate(int size) {
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+      if (it->second >= size) {
+        const auto [offset, available] = *it;
+        freeRanges.erase(it);
+        if (available > size) {
+          freeRanges.emplace(offset + size, available - size);
+        }
+        inUse += size;
+        return offset;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void release(int offset, int size) {
+    inUse -= size;
+    addFree(offset, size);
+  }
+
+private:
+  void addFree(int offset, int size) {
+    // Merge with the free ranges on either side
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.end() && offset + size == next->first) {
+      size += next->second;
+      next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+      const auto prev = std::prev(next);
+      if (prev->first + prev->second == offset) {
+        prev->second += size;
+        return;
+      }
+    }
+    freeRanges.emplace(offset, size);
+  }
+
+  std::map<int, int> freeRanges; // Offset -> size
+  int total = 0;
+  int inUse = 0;
+};
+
+struct ReleasedBatch {
+  std::vector<TerrainMeshRange> ranges;
+  GLsync fence = nullptr;
+  unsigned long releasedFrame = 0;
+};
+
+struct TerrainArena {
+  bool packed = false; // Vertex layout; switching rebuilds the arena
+  unsigned int vao = 0;
+  // Packed: vertex, colour. Float: position, normal, colour.
+  std::array<unsigned int, 3> vertexBuffers{};
+  unsigned int indexBuffer = 0;
+  unsigned int pageTable = 0;     // RGBA32F, xy = chunk origin per page
+  std::vector<float> pageOrigins; // CPU copy of the page table
+  RangeAllocator pages;
+  RangeAllocator indices;
+  int gridFirstIndex = 0; // Shared full-grid indices
+  int meshes = 0;
+  int touchedPages = 0; // Pages below this have held a mesh before
+  int created = 0;      // Uploads into pages never used before
+  int reused = 0;       // Uploads into pages a released mesh had
+  int grows = 0;
+  int shrinks = 0;
+};
+
+TerrainArena arena;
+std::vector<TerrainMeshRange> releasedThisFrame;
+std::vector<ReleasedBatch> retiringBatches;
+unsigned long arenaFrame = 0;
+
+// Per-frame draw lists, kept to avoid reallocating
+std::vector<int> drawCounts;
+std::vector<const void *> drawOffsets;
+std::vector<int> drawBaseVertices;
+
+[[nodiscard]] std::array<int, 3> streamStrides(bool packed) noexcept {
+  if (packed) {
+    return {static_cast<int>(sizeof(PackedTerrainVertex)), 4, 0};
+  }
+  return {3 * static_cast<int>(sizeof(float)), 3 * static_cast<int>(sizeof(float)), 4};
+}
+
+[[nodiscard]] int pagesFor(int vertexCount) noexcept {
+  return (vertexCount + pageVertices - 1) / pageVertices;
+}
+
+void copyBuffer(unsigned int from, unsigned int to, int bytes) {
+  gl.bindBuffer(GL_COPY_READ_BUFFER, from);
+  gl.bindBuffer(GL_COPY_WRITE_BUFFER, to);
+  gl.copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bytes);
+  gl.bindBuffer(GL_COPY_READ_BUFFER, 0);
+  gl.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Same attribute locations UploadMesh() uses
+void setUpVertexArray() {
+  arena.vao = rlLoadVertexArray();
+  rlEnableVertexArray(arena.vao);
+
+  if (arena.packed) {
+    constexpr int vertexStride = static_cast<int>(sizeof(PackedTerrainVertex));
+    rlEnableVertexBuffer(arena.vertexBuffers[0]);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 1, glUnsignedShort, true, vertexStride,
+                         static_cast<int>(offsetof(PackedTerrainVertex, height)));
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_UNSIGNED_BYTE, false, vertexStride,
+                         static_cast<int>(offsetof(PackedTerrainVertex, x)));
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 2, glUnsignedShort, true, vertexStride,
+                         static_cast<int>(offsetof(PackedTerrainVertex, normal)));
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+    rlEnableVertexBuffer(arena.vertexBuffers[1]);
+  } else {
+    rlEnableVertexBuffer(arena.vertexBuffers[0]);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    rlEnableVertexBuffer(arena.vertexBuffers[1]);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+    rlEnableVertexBuffer(arena.vertexBuffers[2]);
+  }
+  rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, 0, 0);
+  rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+
+  rlEnableVertexBufferElement(arena.indexBuffer);
+  rlDisableVertexArray();
+}
+
+// Reallocates every buffer at the new capacity, keeping the contents (up to
+// the new capacity; shrinking only ever cuts off free units)
+void resizeArena(int pageCapacity, int indexCapacity) {
+  const int oldPages = std::min(arena.pages.capacity(), pageCapacity);
+  const int oldIndices = std::min(arena.indices.capacity(), indexCapacity);
+
+  // Creating an element buffer binds it to whatever VAO is bound
+  rlDisableVertexArray();
+  const std::array<int, 3> strides = streamStrides(arena.packed);
+  for (std::size_t i = 0; i < strides.size(); ++i) {
+    if (strides[i] == 0) {
+      continue;
+    }
+    const unsigned int buffer =
+        rlLoadVertexBuffer(nullptr, pageCapacity * pageVertices * strides[i], true);
+    if (arena.vertexBuffers[i] != 0) {
+      copyBuffer(arena.vertexBuffers[i], buffer, oldPages * pageVertices * strides[i]);
+      rlUnloadVertexBuffer(arena.vertexBuffers[i]);
+    }
+    arena.vertexBuffers[i] = buffer;
+  }
+  constexpr int indexSize = static_cast<int>(sizeof(unsigned short));
+  const unsigned int indexBuffer = rlLoadVertexBufferElement(nullptr, indexCapacity * indexSize, true);
+  if (arena.indexBuffer != 0) {
+    copyBuffer(arena.indexBuffer, indexBuffer, oldIndices * indexSize);
+    rlUnloadVertexBuffer(arena.indexBuffer);
+  }
+  arena.indexBuffer = indexBuffer;
+
+  if (arena.vao != 0) {
+    rlUnloadVertexArray(arena.vao);
+  }
+  setUpVertexArray();
+
+  arena.pageOrigins.resize(static_cast<std::size_t>(pageCapacity) * 4, 0.0f);
+  if (arena.pageTable != 0) {
+    rlUnloadTexture(arena.pageTable);
+  }
+  arena.pageTable = rlLoadTexture(arena.pageOrigins.data(), pageTableWidth,
+                                  pageCapacity / pageTableWidth,
+                                  RL_PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+
+  for (RangeAllocator *allocator : {&arena.pages, &arena.indices}) {
+    const int capacity = allocator == &arena.pages ? pageCapacity : indexCapacity;
+    if (capacity >= allocator->capacity()) {
+      allocator->grow(capacity);
+    } else {
+      allocator->shrink(capacity);
+    }
+  }
+  arena.touchedPages = std::min(arena.touchedPages, pageCapacity);
+}
+
+// Halves whichever of the buffers has a free top half and too much idle
+// space, one at a time (each is a GPU copy)
+void trimArena() {
+  const int gridPages = pagesFor(chunkSize * chunkSize);
+  const int pageCapacity = arena.pages.capacity();
+  const int idlePages = pageCapacity - arena.pages.used();
+  if (pageCapacity > initialPages && idlePages > terrainPoolHighWater * gridPages &&
+      arena.pages.freeAtEnd() >= pageCapacity / 2) {
+    resizeArena(pageCapacity / 2, arena.indices.capacity());
+    ++arena.shrinks;
+    return;
+  }
+  const int indexCapacity = arena.indices.capacity();
+  if (indexCapacity > initialIndices && arena.indices.used() < indexCapacity / 4 &&
+      arena.indices.freeAtEnd() >= indexCapacity / 2) {
+    resizeArena(pageCapacity, indexCapacity / 2);
+    ++arena.shrinks;
+  }
+}
+
+void destroyArena() {
+  for (ReleasedBatch &batch : retiringBatches) {
+    if (batch.fence != nullptr) {
+      gl.deleteSync(batch.fence);
+    }
+  }
+  retiringBatches.clear();
+  releasedThisFrame.clear();
+
+  // GL holds on to anything the GPU is still using
+  if (arena.vao != 0) {
+    rlUnloadVertexArray(arena.vao);
+  }
+  for (const unsigned int buffer : arena.vertexBuffers) {
+    if (buffer != 0) {
+      rlUnloadVertexBuffer(buffer);
+    }
+  }
+  if (arena.indexBuffer != 0) {
+    rlUnloadVertexBuffer(arena.indexBuffer);
+  }
+  if (arena.pageTable != 0) {
+    rlUnloadTexture(arena.pageTable);
+  }
+  arena = {};
+}
+
+[[nodiscard]] int allocateIndices(int count) {
+  std::optional<int> first = arena.indices.allocate(count);
+  while (!first) {
+    resizeArena(arena.pages.capacity(), arena.indices.capacity() * 2);
+    ++arena.grows;
+    first = arena.indices.allocate(count);
+  }
+  return *first;
+}
+
+void fillIndices(int firstIndex, const unsigned short *indices, int count) {
+  // Element buffer binding is VAO state, so bind the arena's VAO first
+  rlEnableVertexArray(arena.vao);
+  constexpr int indexSize = static_cast<int>(sizeof(unsigned short));
+  rlUpdateVertexBufferElements(arena.indexBuffer, indices, count * indexSize,
+                               firstIndex * indexSize);
+  rlDisableVertexArray();
+}
+
+// The arena in the current vertex layout. Switching layouts happens with no
+// chunks loaded (see the P key), so the old arena can simply go.
+void ensureArena() {
+  if (arena.vao != 0 && arena.packed == packedTerrainVertices) {
+    return;
+  }
+  destroyArena();
+  arena.packed = packedTerrainVertices;
+  resizeArena(initialPages, initialIndices);
+
+  const std::span<const unsigned short> grid = GetTerrainGridIndices();
+  arena.gridFirstIndex = allocateIndices(static_cast<int>(grid.size()));
+  fillIndices(arena.gridFirstIndex, grid.data(), static_cast<int>(grid.size()));
+}
+
+// Copies the mesh's vertices into fresh pages owned by chunk (cx, cz)
+[[nodiscard]] TerrainMeshRange uploadVertices(const Mesh &mesh, int cx, int cz) {
+  ensureArena();
+  const int pageCount = pagesFor(mesh.vertexCount);
+  std::optional<int> firstPage = arena.pages.allocate(pageCount);
+  while (!firstPage) {
+    resizeArena(arena.pages.capacity() * 2, arena.indices.capacity());
+    ++arena.grows;
+    firstPage = arena.pages.allocate(pageCount);
+  }
+
+  if (*firstPage + pageCount > arena.touchedPages) {
+    arena.touchedPages = *firstPage + pageCount;
+    ++arena.created;
+  } else {
+    ++arena.reused;
+  }
+
+  const int baseVertex = *firstPage * pageVertices;
+  const int vertexCount = mesh.vertexCount;
+  const std::array<int, 3> strides = streamStrides(arena.packed);
+  if (arena.packed) {
+    std::vector<PackedTerrainVertex> packed(static_cast<std::size_t>(vertexCount));
+    for (int i = 0; i < vertexCount; ++i) {
+      packed[static_cast<std::size_t>(i)] = PackTerrainVertex(
+          static_cast<int>(mesh.vertices[i * 3]),
+          static_cast<int>(mesh.vertices[i * 3 + 2]), mesh.vertices[i * 3 + 1],
+          {mesh.normals[i * 3], mesh.normals[i * 3 + 1], mesh.normals[i * 3 + 2]});
+    }
+    rlUpdateVertexBuffer(arena.vertexBuffers[0], packed.data(), vertexCount * strides[0],
+                         baseVertex * strides[0]);
+    rlUpdateVertexBuffer(arena.vertexBuffers[1], mesh.colors, vertexCount * strides[1],
+                         baseVertex * strides[1]);
+  } else {
+    rlUpdateVertexBuffer(arena.vertexBuffers[0], mesh.vertices, vertexCount * strides[0],
+                         baseVertex * strides[0]);
+    rlUpdateVertexBuffer(arena.vertexBuffers[1], mesh.normals, vertexCount * strides[1],
+                         baseVertex * strides[1]);
+    rlUpdateVertexBuffer(arena.vertexBuffers[2], mesh.colors, vertexCount * strides[2],
+                         baseVertex * strides[2]);
+  }
+
+  // Point the pages at the chunk, then upload the page table rows they span
+  for (int page = *firstPage; page < *firstPage + pageCount; ++page) {
+    float *origin = &arena.pageOrigins[static_cast<std::size_t>(page) * 4];
+    origin[0] = static_cast<float>(cx * stride);
+    origin[1] = static_cast<float>(cz * stride);
+  }
+  const int firstRow = *firstPage / pageTableWidth;
+  const int lastRow = (*firstPage + pageCount - 1) / pageTableWidth;
+  rlUpdateTexture(arena.pageTable, 0, firstRow, pageTableWidth, lastRow - firstRow + 1,
+                  RL_PIXELFORMAT_UNCOMPRESSED_R32G32B32A32,
+                  &arena.pageOrigins[static_cast<std::size_t>(firstRow * pageTableWidth) * 4]);
+
+  ++arena.meshes;
+  return {baseVertex, vertexCount, 0, 0, false};
+}
+
+void releaseRange(const TerrainMeshRange &range) {
+  arena.pages.release(range.baseVertex / pageVertices, pagesFor(range.vertexCount));
+  if (range.ownIndices) {
+    arena.indices.release(range.firstIndex, range.indexCount);
+  }
+}
+
+} // namespace
+
+void InitTerrainBuffers() {
+  std::cout << std::format("Terrain grid ACMR (FIFO 16): {:.3f} row-major, {:.3f} optimised",
+                           ComputeACMR(BuildTerrainGridIndices(), 16),
+                           ComputeACMR(GetTerrainGridIndices(), 16))
+            << std::endl;
+  ensureArena();
+}
+
+TerrainMeshRange UploadTerrainMesh(const Mesh &mesh, int cx, int cz) {
+  TerrainMeshRange range = uploadVertices(mesh, cx, cz);
+  range.firstIndex = arena.gridFirstIndex;
+  range.indexCount = static_cast<int>(GetTerrainGridIndices().size());
+  return range;
+}
+
+TerrainMeshRange UploadTerrainLodMesh(const Mesh &mesh, int cx, int cz) {
+  TerrainMeshRange range = uploadVertices(mesh, cx, cz);
+  range.indexCount = mesh.triangleCount * 3;
+  range.firstIndex = allocateIndices(range.indexCount);
+  range.ownIndices = true;
+  fillIndices(range.firstIndex, mesh.indices, range.indexCount);
+  return range;
+}
+
+void ReleaseTerrainMesh(const TerrainMeshRange &range) {
+  --arena.meshes;
+  releasedThisFrame.push_back(range);
+}
+
+void UpdateTerrainArena() {
+  ++arenaFrame;
+
+  std::erase_if(retiringBatches, [](ReleasedBatch &batch) {
+    if (batch.fence != nullptr) {
+      const unsigned int status = gl.clientWaitSync(batch.fence, 0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return false;
+      }
+      gl.deleteSync(batch.fence);
+    } else if (arenaFrame - batch.releasedFrame < fallbackReleaseFrames) {
+      return false;
+    }
+    for (const TerrainMeshRange &range : batch.ranges) {
+      releaseRange(range);
+    }
+    return true;
+  });
+  if (arena.vao != 0) {
+    trimArena();
+  }
+
+  // One fence covers everything released since the last update
+  if (!releasedThisFrame.empty()) {
+    retiringBatches.push_back(
+        {std::move(releasedThisFrame),
+         gl.hasSync() ? gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr,
+         arenaFrame});
+    releasedThisFrame.clear();
+  }
+}
+
+void UnloadTerrainBuffers() { destroyArena(); }
+
+TerrainArenaStats GetTerrainArenaStats() {
+  int retiring = 0;
+  for (const ReleasedBatch &batch : retiringBatches) {
+    retiring += static_cast<int>(batch.ranges.size());
+  }
+  const int idlePages = arena.pages.capacity() - arena.pages.used();
+  return {arena.meshes,
+          idlePages / pagesFor(chunkSize * chunkSize),
+          retiring + static_cast<int>(releasedThisFrame.size()),
+          arena.created,
+          arena.reused,
+          arena.pages.used() * pageVertices,
+          arena.pages.capacity() * pageVertices,
+          arena.indices.used(),
+          arena.indices.capacity(),
+          arena.grows,
+          arena.shrinks};
+}
+
+TerrainDrawStats DrawTerrainChunks(std::span<const Chunk *const> visible,
+                                   const Camera &camera, const Shader &shader) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  TerrainDrawStats stats{};
+  drawCounts.clear();
+  drawOffsets.clear();
+  drawBaseVertices.clear();
+  for (const Chunk *chunk : visible) {
+    const TerrainMeshRange &range =
+        chunk->meshRanges[static_cast<std::size_t>(selectTerrainLod(*chunk, camera))];
+    drawCounts.push_back(range.indexCount);
+    drawOffsets.push_back(reinterpret_cast<const void *>(
+        static_cast<std::uintptr_t>(range.firstIndex) * sizeof(unsigned short)));
+    drawBaseVertices.push_back(range.baseVertex);
+
+    ++stats.chunks;
+    stats.triangles += range.indexCount / 3;
+    stats.vertices += range.vertexCount;
+    stats.fullResTriangles += gridTriangles;
+  }
+
+  if (!drawCounts.empty() && arena.vao != 0 && gl.drawElementsBaseVertex != nullptr) {
+    // raylib batches immediate-mode draws; flush them so they keep their order
+    rlDrawRenderBatchActive();
+
+    // Packed heights are unorm16 over the global height range; the model
+    // matrix maps them back to world units. The range is the same for every
+    // chunk, so shared edge vertices still land on identical positions.
+    const Matrix model =
+        arena.packed ? MatrixMultiply(MatrixScale(1.0f, terrainHeightRange, 1.0f),
+                                      MatrixTranslate(0.0f, terrainHeightMin, 0.0f))
+                     : MatrixIdentity();
+    const Matrix mvp = MatrixMultiply(MatrixMultiply(model, rlGetMatrixModelview()),
+                                      rlGetMatrixProjection());
+
+    rlEnableShader(shader.id);
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MVP], mvp);
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MODEL], model);
+    constexpr int pageTableUnit = 0;
+    rlActiveTextureSlot(pageTableUnit);
+    rlEnableTexture(arena.pageTable);
+    rlSetUniform(GetShaderLocation(shader, "chunkOrigins"), &pageTableUnit,
+                 RL_SHADER_UNIFORM_INT, 1);
+
+    rlEnableVertexArray(arena.vao);
+    const auto drawCount = static_cast<int>(drawCounts.size());
+    if (batchedTerrainDraws && gl.multiDrawElementsBaseVertex != nullptr) {
+      gl.multiDrawElementsBaseVertex(glTriangles, drawCounts.data(), glUnsignedShort,
+                                     drawOffsets.data(), drawCount,
+                                     drawBaseVertices.data());
+      stats.drawCalls = 1;
+    } else {
+      for (int i = 0; i < drawCount; ++i) {
+        const auto at = static_cast<std::size_t>(i);
+        gl.drawElementsBaseVertex(glTriangles, drawCounts[at], glUnsignedShort,
+                                  drawOffsets[at], drawBaseVertices[at]);
+      }
+      stats.drawCalls = drawCount;
+    }
+    rlDisableVertexArray();
+    rlDisableTexture();
+    rlDisableShader();
+  }
+
+  stats.submitMicroseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+  return stats;
+}
+
+std::size_t GetTerrainGpuBytes() {
+  const std::array<int, 3> strides = streamStrides(arena.packed);
+  const auto vertices = static_cast<std::size_t>(arena.pages.capacity() * pageVertices);
+  return vertices * static_cast<std::size_t>(strides[0] + strides[1] + strides[2]) +
+         static_cast<std::size_t>(arena.indices.capacity()) * sizeof(unsigned short) +
+         static_cast<std::size_t>(arena.pages.capacity()) * 4 * sizeof(float);
+}
@@ -1,117 +1,759 @@
-#include "db_perlin.hpp"
 #include "game.h"
 #include "rlgl.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
+#include <numbers>
+#include <optional>
+#include <random>
 #include <vector>
 
+// Vegetation is drawn instanced. Each chunk keeps its instances' transforms
+// grouped by model type (built with the chunk, on a worker). Each frame the
+// visible chunks' groups are gathered per type and LOD and drawn with one
+// DrawMeshInstanced per mesh, so draw calls don't grow with instances.
+// Chunks are culled and pick a LOD as a whole, by their nearest point; the
+// frustum and horizon passes already see vegetation through contentTop.
+//
+// raylib can't load the bundled FBX sources, so a type uses an export next
+// to its source (glb, gltf, obj or iqm) if there is one, and otherwise a
+// procedural stand-in of the same size. The far LOD is always procedural.
+//
+// Trees get a third level: past impostorDistance each is one quad showing
+// an impostor baked from its near model (see impostors.cpp). Over the last
+// impostorFadeWidth units both are drawn and the shaders dither between them.
+
+struct VegetationModelInfo {
+  const char *name;
+  const char *source; // Bundled asset; conifer ships textures only, fern a zip
+  float height;       // World units at scale 1
+  float lodDistance;  // Beyond this, the low-poly mesh
+  float impostorDistance; // Beyond this, the impostor; 0 for none
+  float drawDistance; // Beyond this, nothing
+};
+
+constexpr std::array<VegetationModelInfo, vegetationModelCount> vegetationModels = {{
+    {"stump", "assets/models/4k-tree-stump-megascan/source/wdzkeckbw_LOD0.fbx", 0.8f, 25.0f, 0.0f, 80.0f},
+    {"oak", "assets/models/oak-trees/source/oaktrees.fbx", 9.0f, 40.0f, 80.0f, 1000.0f},
+    {"low-poly tree", "assets/models/trees-low-poly/source/trees.fbx", 7.0f, 40.0f, 80.0f, 1000.0f},
+    {"dry grass", "assets/models/dry-grass/source/sketchfabGrass.fbx", 0.6f, 20.0f, 0.0f, 50.0f},
+    {"conifer", nullptr, 11.0f, 40.0f, 80.0f, 1000.0f},
+    {"fern", nullptr, 0.7f, 20.0f, 0.0f, 50.0f},
+}};
+constexpr int vegetationLods = 2;
+constexpr float impostorFadeWidth = 10.0f;
+
+struct VegetationLod {
+  Model model{};
+  Matrix fit = MatrixIdentity(); // Loaded models: base on the ground, type's height
+  int triangles = 0;
+};
+
 bool vegetationLoaded = false;
-extern Shader lightingShader;
+extern Shader vegetationShader;
+
+static std::array<std::array<VegetationLod, vegetationLods>, vegetationModelCount> vegetationLodModels;
+static std::array<std::array<std::vector<Matrix>, vegetationLods>, vegetationModelCount> frameTransforms;
+static std::array<VegetationImpostor, vegetationModelCount> impostorAtlases;
+static std::array<bool, vegetationModelCount> impostorBaked{};
+static std::array<std::vector<Matrix>, vegetationModelCount> frameImpostorTransforms;
+static VegetationStats vegetationStats{};
+
+constexpr Color barkColor = {70, 55, 40, 255};
+
+// Procedural meshes: positions, normals and colours, no textures
+struct MeshBuilder {
+  std::vector<Vector3> positions;
+  std::vector<Vector3> normals;
+  std::vector<Color> colors;
+  std::vector<unsigned short> indices;
+
+  unsigned short vertex(Vector3 position, Vector3 normal, Color color) {
+    positions.push_back(position);
+    normals.push_back(Vector3Normalize(normal));
+    colors.push_back(color);
+    return static_cast<unsigned short>(positions.size() - 1);
+  }
+
+  void triangle(unsigned short a, unsigned short b, unsigned short c) {
+    indices.insert(indices.end(), {a, b, c});
+  }
+
+  // Side of a (possibly pointed) truncated cone around the Y axis
+  void cone(float y0, float radius0, float y1, float radius1, int sides, Color color) {
+    using std::numbers::pi_v;
+    const float slope = (radius0 - radius1) / (y1 - y0);
+    for (int i = 0; i < sides; ++i) {
+      const float a0 = static_cast<float>(i) / static_cast<float>(sides) * 2.0f * pi_v<float>;
+      const float a1 = static_cast<float>(i + 1) / static_cast<float>(sides) * 2.0f * pi_v<float>;
+      const Vector3 n0 = {std::cos(a0), slope, std::sin(a0)};
+      const Vector3 n1 = {std::cos(a1), slope, std::sin(a1)};
+      const unsigned short b0 = vertex({radius0 * std::cos(a0), y0, radius0 * std::sin(a0)}, n0, color);
+      const unsigned short b1 = vertex({radius0 * std::cos(a1), y0, radius0 * std::sin(a1)}, n1, color);
+      const unsigned short t0 = vertex({radius1 * std::cos(a0), y1, radius1 * std::sin(a0)}, n0, color);
+      const unsigned short t1 = vertex({radius1 * std::cos(a1), y1, radius1 * std::sin(a1)}, n1, color);
+      triangle(b0, t1, b1);
+      triangle(b0, t0, t1);
+    }
+  }
+
+  // Flat cap, facing up or down
+  void disk(float y, float radius, int sides, bool up, Color color) {
+    using std::numbers::pi_v;
+    const Vector3 normal = {0.0f, up ? 1.0f : -1.0f, 0.0f};
+    const unsigned short centre = vertex({0.0f, y, 0.0f}, normal, color);
+    for (int i = 0; i < sides; ++i) {
+      const float a0 = static_cast<float>(i) / static_cast<float>(sides) * 2.0f * pi_v<float>;
+      const float a1 = static_cast<float>(i + 1) / static_cast<float>(sides) * 2.0f * pi_v<float>;
+      const unsigned short v0 = vertex({radius * std::cos(a0), y, radius * std::sin(a0)}, normal, color);
+      const unsigned short v1 = vertex({radius * std::cos(a1), y, radius * std::sin(a1)}, normal, color);
+      if (up) {
+        triangle(centre, v1, v0);
+      } else {
+        triangle(centre, v0, v1);
+      }
+    }
+  }
+
+  // Latitude-longitude ellipsoid, for broadleaf canopies
+  void blob(Vector3 centre, Vector3 radii, int rings, int sides, Color color) {
+    using std::numbers::pi_v;
+    const auto first = static_cast<int>(positions.size());
+    for (int r = 0; r <= rings; ++r) {
+      const float phi = static_cast<float>(r) / static_cast<float>(rings) * pi_v<float>;
+      for (int s = 0; s <= sides; ++s) {
+        const float theta = static_cast<float>(s) / static_cast<float>(sides) * 2.0f * pi_v<float>;
+        const Vector3 unit = {std::sin(phi) * std::cos(theta), std::cos(phi),
+                              std::sin(phi) * std::sin(theta)};
+        vertex({centre.x + unit.x * radii.x, centre.y + unit.y * radii.y,
+                centre.z + unit.z * radii.z},
+               unit, color);
+      }
+    }
+    for (int r = 0; r < rings; ++r) {
+      for (int s = 0; s < sides; ++s) {
+        const auto a = static_cast<unsigned short>(first + r * (sides + 1) + s);
+        const auto b = static_cast<unsigned short>(a + sides + 1);
+        triangle(a, static_cast<unsigned short>(a + 1), b);
+        triangle(static_cast<unsigned short>(a + 1), static_cast<unsigned short>(b + 1), b);
+      }
+    }
+  }
+
+  // Double-sided card from the origin, turned by angle around Y, its top
+  // leaning outward. Lit like the ground it stands on.
+  void card(float angle, float width, float height, float lean, Color color) {
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    const Vector3 up = {0.0f, 1.0f, 0.0f};
+    const float half = width * 0.5f;
+    const unsigned short v0 = vertex({-half * s, 0.0f, half * c}, up, color);
+    const unsigned short v1 = vertex({half * s, 0.0f, -half * c}, up, color);
+    const unsigned short v2 = vertex({half * s + lean * c, height, -half * c + lean * s}, up, color);
+    const unsigned short v3 = vertex({-half * s + lean * c, height, half * c + lean * s}, up, color);
+    triangle(v0, v1, v2);
+    triangle(v0, v2, v3);
+    triangle(v0, v2, v1);
+    triangle(v0, v3, v2);
+  }
+
+  [[nodiscard]] Mesh upload() const {
+    Mesh mesh{};
+    mesh.vertexCount = static_cast<int>(positions.size());
+    mesh.triangleCount = static_cast<int>(indices.size() / 3);
+    mesh.vertices = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+    mesh.normals = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * sizeof(float))));
+    mesh.texcoords = static_cast<float*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * sizeof(float))));
+    mesh.colors = static_cast<unsigned char*>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 4 * sizeof(unsigned char))));
+    mesh.indices = static_cast<unsigned short*>(MemAlloc(static_cast<unsigned int>(indices.size() * sizeof(unsigned short))));
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      std::copy_n(&positions[i].x, 3, mesh.vertices + i * 3);
+      std::copy_n(&normals[i].x, 3, mesh.normals + i * 3);
+      std::copy_n(&colors[i].r, 4, mesh.colors + i * 4);
+    }
+    std::copy(indices.begin(), indices.end(), mesh.indices);
+    UploadMesh(&mesh, false);
+    return mesh;
+  }
+};
+
+// Stand-ins at each type's height; lod 1 has about a quarter the triangles
+static Mesh buildProceduralVegetation(int modelType, int lod) {
+  using std::numbers::pi_v;
+  const bool detailed = lod == 0;
+  const int sides = detailed ? 8 : 4;
+  MeshBuilder builder;
+  switch (modelType) {
+  case 0: // Stump
+    builder.cone(0.0f, 0.45f, 0.8f, 0.4f, sides, barkColor);
+    builder.disk(0.8f, 0.4f, sides, true, Color{120, 100, 70, 255});
+    break;
+  case 1: // Oak
+    builder.cone(0.0f, 0.35f, 4.5f, 0.25f, sides, barkColor);
+    builder.blob({0.0f, 6.0f, 0.0f}, {3.0f, 3.0f, 3.0f}, detailed ? 6 : 3, detailed ? 10 : 5,
+                 Color{60, 80, 40, 255});
+    break;
+  case 2: // Low-poly tree
+    builder.cone(0.0f, 0.25f, 3.0f, 0.2f, sides, barkColor);
+    builder.cone(2.5f, 2.2f, 7.0f, 0.0f, sides, Color{75, 95, 45, 255});
+    builder.disk(2.5f, 2.2f, sides, false, Color{75, 95, 45, 255});
+    break;
+  case 3: // Dry grass
+    for (int i = 0; i < (detailed ? 3 : 2); ++i) {
+      builder.card(static_cast<float>(i) * pi_v<float> / (detailed ? 3.0f : 2.0f), 0.8f, 0.6f,
+                   0.0f, Color{75, 70, 40, 255});
+    }
+    break;
+  case 4: { // Conifer, in tiers
+    constexpr Color needles = {35, 60, 40, 255};
+    builder.cone(0.0f, 0.3f, 3.0f, 0.15f, sides, barkColor);
+    if (detailed) {
+      constexpr std::array<std::array<float, 3>, 3> tiers = {{
+          {2.0f, 2.6f, 6.0f}, {4.5f, 2.0f, 8.5f}, {7.0f, 1.3f, 11.0f}}};
+      for (const auto &[base, radius, top] : tiers) {
+        builder.cone(base, radius, top, 0.0f, sides, needles);
+        builder.disk(base, radius, sides, false, needles);
+      }
+    } else {
+      builder.cone(2.0f, 2.6f, 11.0f, 0.0f, sides, needles);
+      builder.disk(2.0f, 2.6f, sides, false, needles);
+    }
+    break;
+  }
+  default: // Fern: fronds leaning out from the centre
+    for (int i = 0; i < (detailed ? 6 : 3); ++i) {
+      builder.card(static_cast<float>(i) * 2.0f * pi_v<float> / (detailed ? 6.0f : 3.0f), 0.35f,
+                   0.7f, 0.5f, Color{55, 85, 45, 255});
+    }
+    break;
+  }
+  return builder.upload();
+}
+
+// An export raylib can read next to the FBX source, if there is one
+static std::optional<Model> loadExportedModel(const char *source) {
+  if (source == nullptr) {
+    return std::nullopt;
+  }
+  for (const char *extension : {".glb", ".gltf", ".obj", ".iqm"}) {
+    const std::filesystem::path exported =
+        std::filesystem::path(source).replace_extension(extension);
+    if (std::filesystem::exists(exported)) {
+      const Model model = LoadModel(exported.string().c_str());
+      if (model.meshCount > 0) {
+        return model;
+      }
+      UnloadModel(model);
+    }
+  }
+  return std::nullopt;
+}
+
+// Farthest point of the chunk's bounds (vegetation included, as in
+// ChunkDistance())
+static float chunkFarthestDistance(const Chunk &chunk, Vector3 eye) {
+  constexpr float stride = 31.0f;
+  const float minX = static_cast<float>(chunk.x) * stride;
+  const float minZ = static_cast<float>(chunk.z) * stride;
+  const float dx = std::max(std::abs(minX - eye.x), std::abs(minX + stride - eye.x));
+  const float dy = std::max(std::abs(chunk.minHeight - eye.y), std::abs(chunk.contentTop - eye.y));
+  const float dz = std::max(std::abs(minZ - eye.z), std::abs(minZ + stride - eye.z));
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static int countTriangles(const Model &model) {
+  int triangles = 0;
+  for (int m = 0; m < model.meshCount; ++m) {
+    triangles += model.meshes[m].triangleCount;
+  }
+  return triangles;
+}
 
 void LoadVegetationModels() {
+  for (int type = 0; type < vegetationModelCount; ++type) {
+    const VegetationModelInfo &info = vegetationModels[static_cast<std::size_t>(type)];
+    auto &lods = vegetationLodModels[static_cast<std::size_t>(type)];
+
+    if (std::optional<Model> model = loadExportedModel(info.source)) {
+      const BoundingBox box = GetModelBoundingBox(*model);
+      const float scale = info.height / std::max(box.max.y - box.min.y, 0.001f);
+      lods[0].model = *model;
+      lods[0].fit = MatrixMultiply(
+          MatrixTranslate(-(box.min.x + box.max.x) * 0.5f, -box.min.y,
+                          -(box.min.z + box.max.z) * 0.5f),
+          MatrixScale(scale, scale, scale));
+      std::cout << "Vegetation " << info.name << ": loaded " << info.source << std::endl;
+    } else {
+      lods[0].model = LoadModelFromMesh(buildProceduralVegetation(type, 0));
+      std::cout << "Vegetation " << info.name << ": procedural" << std::endl;
+    }
+    lods[1].model = LoadModelFromMesh(buildProceduralVegetation(type, 1));
+    for (VegetationLod &level : lods) {
+      level.triangles = countTriangles(level.model);
+    }
+
+    if (info.impostorDistance > 0.0f) {
+      impostorAtlases[static_cast<std::size_t>(type)] =
+          BakeVegetationImpostor(lods[0].model, lods[0].fit);
+      impostorBaked[static_cast<std::size_t>(type)] = true;
+    }
+  }
+
   vegetationLoaded = true;
-  std::cout << "Vegetation ready (procedural)" << std::endl;
+  const auto baked = std::count(impostorBaked.begin(), impostorBaked.end(), true);
+  std::cout << "Vegetation ready (" << vegetationModelCount << " models, " << baked
+            << " impostors, "
+            << static_cast<float>(baked * GetImpostorAtlasBytes()) / (1024.0f * 1024.0f)
+            << " MB of atlases)" << std::endl;
+}
+
+Shader LoadVegetationShader() {
+  Shader shader = LoadLightingShader("#define VEGETATION\n");
+  // A failed load hands back raylib's default shader, whose locations are
+  // shared; leave those alone
+  if (shader.id != 0 && shader.id != rlGetShaderIdDefault()) {
+    // Where DrawMeshInstanced feeds the per-instance matrices
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+  }
+  return shader;
+}
+
+// Placement draws from two tileable Poisson-disk point sets over a
+// chunk-sized tile, one per density class, generated once from a fixed seed.
+// Every chunk uses the same positions, so chunks meet without seams or
+// clumps; each point also has a rank in [0, 1), which a chunk offsets by a
+// hash of its coordinates before testing it against the local density. The
+// surviving subset differs per chunk and keeps the disk spacing. Tiles are
+// sorted by rank, so the points that can pass are one run of the tile and
+// the rest are never looked at. Everything else that depends only on the
+// position (the grid cell and weights, a facing and a size jitter) is
+// worked out with the tile too; a chunk adds its own turn to every facing.
+struct PlacementPoint {
+  float x, z; // Chunk-local, in [0, 31)
+  float rank;
+  int vertex;      // Grid vertex at the cell's low corner
+  float fx, fz;    // Position within the cell
+  float angle;     // Degrees
+  float cosAngle, sinAngle;
+  float jitter;    // In [0, 1)
+};
+
+constexpr float placementTileSize = 31.0f;
+constexpr float treeSpacing = 4.0f;
+constexpr float undergrowthSpacing = 2.0f;
+
+static std::uint32_t hashPlacement(std::uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x;
 }
 
-[[nodiscard]] bool isOnPathVeg(float wx, float wz) noexcept {
-  const float pathNoise1 =
-      db::perlin(wx * 0.015f + 1000.0f, wz * 0.015f + 1000.0f);
-  const float pathNoise2 =
-      db::perlin(wx * 0.02f + 2000.0f, wz * 0.02f + 2000.0f);
-  const float pathValue = std::abs(pathNoise1) + std::abs(pathNoise2) * 0.5f;
+static float unitFromHash(std::uint32_t h) {
+  return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Bridson's algorithm with distances measured around the tile's edges
+static std::vector<PlacementPoint> generatePoissonTile(float spacing, std::uint32_t seed) {
+  constexpr float size = placementTileSize;
+  std::mt19937 gen(seed);
+  const auto random = [&gen] { return unitFromHash(static_cast<std::uint32_t>(gen())); };
 
-  if (pathValue < 0.15f) {
+  // Cells no wider than spacing / sqrt(2) hold at most one point each
+  const int cells = static_cast<int>(std::ceil(size * std::numbers::sqrt2_v<float> / spacing));
+  const float cellSize = size / static_cast<float>(cells);
+  std::vector<int> grid(static_cast<std::size_t>(cells * cells), -1);
+  const auto cellOf = [&](float v) {
+    return std::min(static_cast<int>(v / cellSize), cells - 1);
+  };
+  const auto wrap = [](float v) { return v - size * std::floor(v / size); };
+  const auto wrapDelta = [](float d) {
+    return d > size * 0.5f ? d - size : d < -size * 0.5f ? d + size : d;
+  };
+
+  std::vector<PlacementPoint> points;
+  std::vector<int> active;
+  const auto fits = [&](float x, float z) {
+    const int cx = cellOf(x);
+    const int cz = cellOf(z);
+    for (int dz = -2; dz <= 2; ++dz) {
+      for (int dx = -2; dx <= 2; ++dx) {
+        const int gx = (cx + dx + cells) % cells;
+        const int gz = (cz + dz + cells) % cells;
+        const int other = grid[static_cast<std::size_t>(gz * cells + gx)];
+        if (other < 0) {
+          continue;
+        }
+        const PlacementPoint &p = points[static_cast<std::size_t>(other)];
+        const float ox = wrapDelta(p.x - x);
+        const float oz = wrapDelta(p.z - z);
+        if (ox * ox + oz * oz < spacing * spacing) {
+          return false;
+        }
+      }
+    }
     return true;
+  };
+  const auto add = [&](float x, float z) {
+    grid[static_cast<std::size_t>(cellOf(z) * cells + cellOf(x))] =
+        static_cast<int>(points.size());
+    active.push_back(static_cast<int>(points.size()));
+    PlacementPoint point{};
+    point.x = x;
+    point.z = z;
+    point.rank = random();
+    constexpr int chunkSize = 32;
+    const int vx = std::min(static_cast<int>(x), chunkSize - 2);
+    const int vz = std::min(static_cast<int>(z), chunkSize - 2);
+    point.vertex = vz * chunkSize + vx;
+    point.fx = x - static_cast<float>(vx);
+    point.fz = z - static_cast<float>(vz);
+    point.angle = random() * 360.0f;
+    point.cosAngle = std::cos(point.angle * DEG2RAD);
+    point.sinAngle = std::sin(point.angle * DEG2RAD);
+    point.jitter = random();
+    points.push_back(point);
+  };
+
+  add(random() * size, random() * size);
+  constexpr int attempts = 30;
+  while (!active.empty()) {
+    const std::size_t pick = gen() % active.size();
+    const PlacementPoint from = points[static_cast<std::size_t>(active[pick])];
+    bool placed = false;
+    for (int attempt = 0; attempt < attempts && !placed; ++attempt) {
+      const float angle = random() * 2.0f * std::numbers::pi_v<float>;
+      const float radius = spacing * (1.0f + random());
+      const float x = wrap(from.x + radius * std::cos(angle));
+      const float z = wrap(from.z + radius * std::sin(angle));
+      if (fits(x, z)) {
+        add(x, z);
+        placed = true;
+      }
+    }
+    if (!placed) {
+      active[pick] = active.back();
+      active.pop_back();
+    }
   }
 
-  const float secondaryPath =
-      db::perlin(wx * 0.01f + 5000.0f, wz * 0.01f + 5000.0f);
-  return std::abs(secondaryPath) < 0.08f;
+  std::sort(points.begin(), points.end(),
+            [](const PlacementPoint &a, const PlacementPoint &b) { return a.rank < b.rank; });
+  return points;
 }
 
-void GenerateVegetationForChunk(Chunk &chunk) {
-  return; // no vegetation for now
-  if (!vegetationLoaded) {
-    return;
+// Calls fn(point, shifted rank) for the points whose rank, offset by
+// offset and wrapped to [0, 1), is below limit
+template <typename Fn>
+static void forEachRanked(std::span<const PlacementPoint> points, float offset, float limit,
+                          Fn &&fn) {
+  const auto byRank = [](const PlacementPoint &point, float rank) { return point.rank < rank; };
+  const auto run = [&](float from, float to, float shift) {
+    auto it = std::lower_bound(points.begin(), points.end(), from, byRank);
+    for (; it != points.end() && it->rank < to; ++it) {
+      fn(*it, it->rank + shift);
+    }
+  };
+  // rank + offset < limit, or rank + offset - 1 < limit once wrapped
+  run(1.0f - offset, std::min(1.0f - offset + limit, 1.0f), offset - 1.0f);
+  run(0.0f, limit - offset, offset);
+}
+
+static std::span<const PlacementPoint> treePoints() {
+  static const std::vector<PlacementPoint> points = generatePoissonTile(treeSpacing, 1u);
+  return points;
+}
+
+static std::span<const PlacementPoint> undergrowthPoints() {
+  static const std::vector<PlacementPoint> points =
+      generatePoissonTile(undergrowthSpacing, 2u);
+  return points;
+}
+
+// Ground under a tile point, on the terrain mesh's triangles (split along
+// the top-right to bottom-left diagonal)
+struct GroundSample {
+  float height;       // World units
+  float slopeSquared; // Rise over run
+  float moisture;
+  float path;
+};
+
+static GroundSample sampleGround(const Chunk &chunk, std::span<const float> pathInfluence,
+                                 const PlacementPoint &point) {
+  constexpr int chunkSize = 32;
+  const float fx = point.fx;
+  const float fz = point.fz;
+  const int i00 = point.vertex;
+  const int i10 = i00 + 1;
+  const int i01 = i00 + chunkSize;
+  const int i11 = i01 + 1;
+  const auto at = [](const std::vector<float> &grid, int i) {
+    return grid[static_cast<std::size_t>(i)];
+  };
+
+  const float h00 = at(chunk.heights, i00) * 5.0f;
+  const float h10 = at(chunk.heights, i10) * 5.0f;
+  const float h01 = at(chunk.heights, i01) * 5.0f;
+  const float h11 = at(chunk.heights, i11) * 5.0f;
+  GroundSample ground{};
+  if (fx + fz <= 1.0f) {
+    ground.height = h00 + fx * (h10 - h00) + fz * (h01 - h00);
+    ground.slopeSquared = (h10 - h00) * (h10 - h00) + (h01 - h00) * (h01 - h00);
+  } else {
+    ground.height = h11 + (1.0f - fx) * (h01 - h11) + (1.0f - fz) * (h10 - h11);
+    ground.slopeSquared = (h11 - h01) * (h11 - h01) + (h11 - h10) * (h11 - h10);
   }
 
+  const auto bilinear = [&](float v00, float v10, float v01, float v11) {
+    return (v00 + (v10 - v00) * fx) * (1.0f - fz) + (v01 + (v11 - v01) * fx) * fz;
+  };
+  ground.moisture = bilinear(at(chunk.moisture, i00), at(chunk.moisture, i10),
+                             at(chunk.moisture, i01), at(chunk.moisture, i11));
+  const auto path = [&](int i) { return pathInfluence[static_cast<std::size_t>(i)]; };
+  ground.path = bilinear(path(i00), path(i10), path(i01), path(i11));
+  return ground;
+}
+
+void GenerateVegetationForChunk(Chunk &chunk, std::span<const float> pathInfluence) {
   chunk.vegetation.clear();
+  for (std::vector<Matrix> &transforms : chunk.vegetationTransforms) {
+    transforms.clear();
+  }
+  // Placement only needs the model table, not the loaded models, so chunks
+  // come out the same headless (raven_bench); DrawVegetation() checks those
 
-  constexpr int chunkSize = 32;
-  constexpr int stride = 31;
+  constexpr float stride = 31.0f;
+  const std::uint32_t chunkHash = hashPlacement(static_cast<std::uint32_t>(chunk.x) * 73856093u ^
+                                                static_cast<std::uint32_t>(chunk.z) * 19349663u);
 
-  // Sample every 2-3 vertices
-  for (int z = 2; z < chunkSize - 2; z += 3) {
-    for (int x = 2; x < chunkSize - 2; x += 3) {
-      const int idx = z * chunkSize + x;
-      const float height = chunk.heights[idx];
+  // One turn for the whole chunk, added to each point's own
+  const float chunkAngle = unitFromHash(chunkHash) * 360.0f;
+  const float chunkCos = std::cos(chunkAngle * DEG2RAD);
+  const float chunkSin = std::sin(chunkAngle * DEG2RAD);
 
-      const float wx = static_cast<float>(chunk.x * stride + x);
-      const float wz = static_cast<float>(chunk.z * stride + z);
+  const auto place = [&](const PlacementPoint &point, const GroundSample &ground,
+                         int modelType, float scale) {
+    VegetationInstance veg;
+    veg.position = {static_cast<float>(chunk.x) * stride + point.x, ground.height,
+                    static_cast<float>(chunk.z) * stride + point.z};
+    veg.rotation = point.angle + chunkAngle;
+    veg.scale = scale;
+    veg.modelType = modelType;
+    chunk.vegetation.emplace_back(veg);
 
-      // Skip paths
-      if (isOnPathVeg(wx, wz)) {
-        continue;
-      }
+    // MatrixScale * MatrixRotateY * MatrixTranslate, written out
+    const float c = (point.cosAngle * chunkCos - point.sinAngle * chunkSin) * veg.scale;
+    const float sn = (point.sinAngle * chunkCos + point.cosAngle * chunkSin) * veg.scale;
+    const Matrix transform = {c,    0.0f,      sn,   veg.position.x,
+                              0.0f, veg.scale, 0.0f, veg.position.y,
+                              -sn,  0.0f,      c,    veg.position.z,
+                              0.0f, 0.0f,      0.0f, 1.0f};
+    chunk.vegetationTransforms[static_cast<std::size_t>(veg.modelType)].push_back(transform);
+    chunk.contentTop = std::max(
+        chunk.contentTop,
+        veg.position.y +
+            veg.scale * vegetationModels[static_cast<std::size_t>(veg.modelType)].height);
+  };
 
-      const float placementNoise =
-          db::perlin(wx * 0.3f + 3000.0f, wz * 0.3f + 3000.0f);
+  // Never on paths (drawn ones, or a path band too steep to draw one) or
+  // under water. The band comes from the path field, so it's tested last.
+  const auto unplantable = [&chunk](const PlacementPoint &point, const GroundSample &ground) {
+    return ground.path > 0.0f || ground.height < waterLevel ||
+           isInPathBand(static_cast<float>(chunk.x) * stride + point.x,
+                        static_cast<float>(chunk.z) * stride + point.z);
+  };
 
-      // Only place grass sometimes
-      if (placementNoise < -2.0f) {
-        continue;
-      }
+  // Trees: denser where it's wet; broadleaf there, conifers where it's dry
+  const float treeOffset = unitFromHash(chunkHash ^ 0x9e3779b9u);
+  constexpr float maxTreeDensity = 0.8f;
+  forEachRanked(treePoints(), treeOffset, maxTreeDensity,
+                [&](const PlacementPoint &point, float rank) {
+    const GroundSample ground = sampleGround(chunk, pathInfluence, point);
+    const float density = std::clamp(ground.moisture * 1.2f - 0.1f, 0.1f, maxTreeDensity);
+    constexpr float maxSlope = 1.2f;
+    if (rank >= density || ground.slopeSquared > maxSlope * maxSlope || unplantable(point, ground)) {
+      return;
+    }
+    const int type = ground.moisture > 0.6f ? 1 : ground.moisture < 0.45f ? 4 : 2;
+    place(point, ground, type, 0.7f + point.jitter * 0.5f);
+  });
 
-      const float jitterX =
-          db::perlin(wx * 0.5f + 5000.0f, wz * 0.5f + 5000.0f) * 1.5f;
-      const float jitterZ =
-          db::perlin(wx * 0.5f + 6000.0f, wz * 0.5f + 6000.0f) * 1.5f;
+  // Undergrowth: a few stumps, ferns in the wet, dry grass elsewhere
+  const float undergrowthOffset = unitFromHash(chunkHash ^ 0x85ebca6bu);
+  constexpr float stumpDensity = 0.03f;
+  constexpr float maxFernDensity = 0.15f;
+  constexpr float grassDensity = 0.45f;
+  forEachRanked(undergrowthPoints(), undergrowthOffset,
+                stumpDensity + maxFernDensity + grassDensity,
+                [&](const PlacementPoint &point, float rank) {
+    const GroundSample ground = sampleGround(chunk, pathInfluence, point);
+    const float fernDensity = std::clamp((ground.moisture - 0.5f) * 0.8f, 0.0f, maxFernDensity);
+    const int type = rank < stumpDensity                 ? 0
+                     : rank < stumpDensity + fernDensity ? 5
+                     : rank >= stumpDensity + maxFernDensity ? 3
+                                                             : -1;
+    if (type < 0 || unplantable(point, ground)) {
+      return;
+    }
+    const float scale = type == 0   ? 0.8f + ground.moisture * 0.4f
+                        : type == 5 ? 0.6f + ground.moisture * 0.6f
+                                    : 0.25f + point.jitter * 0.15f;
+    place(point, ground, type, scale);
+  });
+}
 
-      VegetationInstance veg;
-      veg.position = {static_cast<float>(chunk.x * stride + x) + jitterX,
-                      height * 5.0f,
-                      static_cast<float>(chunk.z * stride + z) + jitterZ};
-      veg.rotation = placementNoise * 360.0f;
-      veg.scale = 0.3f + placementNoise * 0.2f;
-      veg.modelType = 0;
-      chunk.vegetation.emplace_back(veg);
+float NearestVegetationDistance(std::span<const Chunk *const> visible, Vector3 eye) {
+  float nearest = fog.end;
+  if (!vegetationLoaded) {
+    return nearest;
+  }
+  for (const Chunk *chunk : visible) {
+    const float distance = ChunkDistance(*chunk, eye);
+    if (distance >= nearest) {
+      continue;
+    }
+    // The same test DrawVegetation() uses to skip a type
+    for (std::size_t type = 0; type < vegetationModels.size(); ++type) {
+      const bool replaced = gpuGrass && type == 3;
+      if (!chunk->vegetationTransforms[type].empty() && !replaced &&
+          distance <= vegetationModels[type].drawDistance) {
+        nearest = distance;
+        break;
+      }
     }
   }
+  return nearest;
 }
 
-void DrawVegetation(const Chunk &chunk, const Camera &camera) {
-  return; // no vegetation for now
-  if (!vegetationLoaded) {
+void DrawVegetation(std::span<const Chunk *const> visible, const Camera &camera) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  vegetationStats = {};
+  if (!vegetationLoaded || vegetationShader.id == 0) {
     return;
   }
 
-  constexpr float maxDrawDistance = 150.0f;
-
-  for (const auto &veg : chunk.vegetation) {
-    const float dist = Vector3Distance(camera.position, veg.position);
-    if (dist > maxDrawDistance) {
-      continue;
+  for (auto &lods : frameTransforms) {
+    for (std::vector<Matrix> &transforms : lods) {
+      transforms.clear();
     }
+  }
+  for (std::vector<Matrix> &transforms : frameImpostorTransforms) {
+    transforms.clear();
+  }
 
-    const Vector3 grassPos = {veg.position.x, veg.position.y + 0.05f,
-                              veg.position.z};
+  // A chunk straddling impostorDistance goes to both lists; per instance the
+  // shaders keep one or the other (or dither across the fade band)
+  for (const Chunk *chunk : visible) {
+    const float distance = ChunkDistance(*chunk, camera.position);
+    const float farthest = chunkFarthestDistance(*chunk, camera.position);
+    for (std::size_t type = 0; type < vegetationModels.size(); ++type) {
+      const std::vector<Matrix> &transforms = chunk->vegetationTransforms[type];
+      const VegetationModelInfo &info = vegetationModels[type];
+      // GPU grass stands in for the dry grass model (see grass.cpp)
+      const bool replaced = gpuGrass && type == 3;
+      if (transforms.empty() || distance > std::min(info.drawDistance, fog.end) || replaced) {
+        continue;
+      }
+      const auto count = static_cast<int>(transforms.size());
 
-    // Dead grass color
-    constexpr Color grassColor = {75, 70, 40, 200};
+      const bool impostor = vegetationImpostors && impostorBaked[type];
+      const bool geometry = !impostor || distance < info.impostorDistance;
+      if (geometry) {
+        const std::size_t lod = distance > info.lodDistance ? 1 : 0;
+        std::vector<Matrix> &out = frameTransforms[type][lod];
+        out.insert(out.end(), transforms.begin(), transforms.end());
+        vegetationStats.triangles +=
+            static_cast<std::int64_t>(count) * vegetationLodModels[type][lod].triangles;
+        vegetationStats.instances[type] += count;
+      }
+      if (impostor && farthest > info.impostorDistance - impostorFadeWidth) {
+        std::vector<Matrix> &out = frameImpostorTransforms[type];
+        out.insert(out.end(), transforms.begin(), transforms.end());
+        vegetationStats.impostors += count;
+        vegetationStats.triangles += static_cast<std::int64_t>(count) * 2;
+        if (!geometry) {
+          // What these would have cost as the far mesh
+          vegetationStats.geometryTriangles +=
+              static_cast<std::int64_t>(count) * vegetationLodModels[type][1].triangles;
+          vegetationStats.instances[type] += count;
+        }
+      }
+    }
+  }
+  vegetationStats.geometryTriangles += vegetationStats.triangles - 2 * vegetationStats.impostors;
+
+  // Cards and leaves are seen from both sides
+  rlDisableBackfaceCulling();
+  for (std::size_t type = 0; type < vegetationModels.size(); ++type) {
+    for (std::size_t lod = 0; lod < vegetationLods; ++lod) {
+      const std::vector<Matrix> &transforms = frameTransforms[type][lod];
+      if (transforms.empty()) {
+        continue;
+      }
 
-    rlPushMatrix();
-    rlTranslatef(grassPos.x, grassPos.y, grassPos.z);
-    rlRotatef(90, 1, 0, 0);           // Rotate to lay flat
-    rlRotatef(veg.rotation, 0, 0, 1); // Random rotation
+      const VegetationLod &level = vegetationLodModels[type][lod];
+      const VegetationModelInfo &info = vegetationModels[type];
+      // Past the fade band the impostor has taken over; without one, never
+      const Vector2 fade = vegetationImpostors && impostorBaked[type]
+                               ? Vector2{info.impostorDistance - impostorFadeWidth,
+                                         info.impostorDistance}
+                               : Vector2{1e9f, 2e9f};
+      SetShaderValueMatrix(vegetationShader, GetShaderLocation(vegetationShader, "vegetationFit"),
+                           level.fit);
+      SetShaderValue(vegetationShader, GetShaderLocation(vegetationShader, "impostorFade"), &fade,
+                     SHADER_UNIFORM_VEC2);
 
-    DrawCubeV(Vector3{0, 0, 0},
-              Vector3{veg.scale * 0.8f, veg.scale * 0.6f, 0.02f}, grassColor);
+      for (int m = 0; m < level.model.meshCount; ++m) {
+        Material material = level.model.materials[level.model.meshMaterial[m]];
+        material.shader = vegetationShader;
+        DrawMeshInstanced(level.model.meshes[m], material, transforms.data(),
+                          static_cast<int>(transforms.size()));
+        ++vegetationStats.drawCalls;
+      }
+    }
 
-    rlPopMatrix();
+    const std::vector<Matrix> &impostors = frameImpostorTransforms[type];
+    if (!impostors.empty()) {
+      const VegetationModelInfo &info = vegetationModels[type];
+      DrawVegetationImpostors(impostorAtlases[type], impostors,
+                              {info.impostorDistance - impostorFadeWidth, info.impostorDistance});
+      ++vegetationStats.drawCalls;
+    }
   }
+  rlEnableBackfaceCulling();
+
+  vegetationStats.impostorBytes =
+      static_cast<std::size_t>(std::count(impostorBaked.begin(), impostorBaked.end(), true)) *
+      GetImpostorAtlasBytes();
+
+  vegetationStats.microseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
 }
 
+VegetationStats GetVegetationStats() { return vegetationStats; }
+
 void UnloadVegetationModels() {
+  for (auto &lods : vegetationLodModels) {
+    for (VegetationLod &level : lods) {
+      UnloadModel(level.model);
+      level = {};
+    }
+  }
+  for (std::size_t type = 0; type < impostorAtlases.size(); ++type) {
+    if (impostorBaked[type]) {
+      UnloadVegetationImpostor(impostorAtlases[type]);
+      impostorBaked[type] = false;
+    }
+  }
+  UnloadImpostorQuad();
   vegetationLoaded = false;
   std::cout << "Vegetation unloaded" << std::endl;
 }
@@ -1,38 +1,149 @@
 // src/game/water.cpp
 #include "game.h"
 #include "rlgl.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
-Model waterPlane;
-constexpr float waterLevel = 10.0f;
+// Water only where there is some. When a chunk is generated, its cells with
+// any corner below waterLevel are merged into rectangles, each stored as the
+// transform of a unit quad. Each frame the visible chunks' rectangles are
+// drawn in one instanced pass after the opaque geometry, blended, with the
+// depth test on and depth writes off. Terrain above the surface hides the
+// parts of shoreline cells that poke under it.
 
-extern Shader lightingShader;
+extern Shader waterShader;
 
-void InitWater() {
-  // Create large water plane
-  Mesh waterMesh = GenMeshPlane(2000.0f, 2000.0f, 1, 1);
-  waterPlane = LoadModelFromMesh(waterMesh);
+static Mesh waterQuad{};
+static Material waterMaterial{};
+static std::vector<Matrix> frameTransforms;
+static WaterStats waterStats{};
 
-  // Apply fog shader
-  waterPlane.materials[0].shader = lightingShader;
+Shader LoadWaterShader() {
+  Shader shader = LoadLightingShader("#define WATER\n");
+  if (shader.id != 0 && shader.id != rlGetShaderIdDefault()) {
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+  }
+  return shader;
+}
 
-  // Water color
-  waterPlane.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = {20, 30, 100, 180};
+void InitWater() {
+  waterQuad = GenMeshPlane(1.0f, 1.0f, 1, 1);
+  waterMaterial = LoadMaterialDefault();
+  waterMaterial.shader = waterShader;
+  waterMaterial.maps[MATERIAL_MAP_DIFFUSE].color = {20, 30, 100, 180};
 
   std::cout << "Water initialized at level: " << waterLevel << std::endl;
 }
 
-void DrawWater(const Camera &camera) {
-  // Draw water plane at fixed height, centered on camera
-  const Vector3 waterPos = {camera.position.x, waterLevel, camera.position.z};
+std::vector<Matrix> BuildWaterPatches(const Chunk &chunk) {
+  constexpr int chunkSize = 32;
+  constexpr int cells = chunkSize - 1;
+
+  std::array<bool, cells * cells> wet{};
+  bool any = false;
+  for (int z = 0; z < cells; ++z) {
+    for (int x = 0; x < cells; ++x) {
+      const int v = z * chunkSize + x;
+      const float lowest = std::min({chunk.heights[v], chunk.heights[v + 1],
+                                     chunk.heights[v + chunkSize],
+                                     chunk.heights[v + chunkSize + 1]}) * 5.0f;
+      wet[z * cells + x] = lowest < waterLevel;
+      any = any || lowest < waterLevel;
+    }
+  }
+  std::vector<Matrix> patches;
+  if (!any) {
+    return patches;
+  }
 
-  // Enable transparency
-  rlSetBlendMode(BLEND_ALPHA);
-  DrawModel(waterPlane, waterPos, 1.0f, WHITE);
-  rlSetBlendMode(BLEND_ALPHA);
+  // Greedy rectangles: widest run first, then as many rows as match it
+  const float originX = static_cast<float>(chunk.x * cells);
+  const float originZ = static_cast<float>(chunk.z * cells);
+  for (int z = 0; z < cells; ++z) {
+    for (int x = 0; x < cells; ++x) {
+      if (!wet[z * cells + x]) {
+        continue;
+      }
+      int width = 1;
+      while (x + width < cells && wet[z * cells + x + width]) {
+        ++width;
+      }
+      const auto run = [&wet, x](int row) { return wet.begin() + row * cells + x; };
+      int depth = 1;
+      while (z + depth < cells && std::all_of(run(z + depth), run(z + depth) + width,
+                                              [](bool cell) { return cell; })) {
+        ++depth;
+      }
+      for (int dz = 0; dz < depth; ++dz) {
+        std::fill_n(run(z + dz), width, false);
+      }
+
+      const auto w = static_cast<float>(width);
+      const auto d = static_cast<float>(depth);
+      patches.push_back(MatrixMultiply(
+          MatrixScale(w, 1.0f, d),
+          MatrixTranslate(originX + static_cast<float>(x) + w * 0.5f, waterLevel,
+                          originZ + static_cast<float>(z) + d * 0.5f)));
+    }
+  }
+  return patches;
 }
 
+void DrawWater(std::span<const Chunk *const> visible) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  waterStats = {};
+  frameTransforms.clear();
+  for (const Chunk *chunk : visible) {
+    if (!chunk->waterPatches.empty()) {
+      frameTransforms.insert(frameTransforms.end(), chunk->waterPatches.begin(),
+                             chunk->waterPatches.end());
+      ++waterStats.chunks;
+    }
+  }
+
+  if (!frameTransforms.empty() && waterShader.id != 0) {
+    // Transparent: tested against the opaque depth but not written, and
+    // seen from below too
+    rlDisableDepthMask();
+    rlDisableBackfaceCulling();
+    DrawMeshInstanced(waterQuad, waterMaterial, frameTransforms.data(),
+                      static_cast<int>(frameTransforms.size()));
+    rlEnableBackfaceCulling();
+    rlEnableDepthMask();
+    waterStats.patches = static_cast<int>(frameTransforms.size());
+    waterStats.drawCalls = 1;
+  }
+
+  waterStats.microseconds =
+      std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+}
+
+float NearestWaterDistance(std::span<const Chunk *const> visible, Vector3 eye) {
+  float nearest = fog.end;
+  for (const Chunk *chunk : visible) {
+    for (const Matrix &patch : chunk->waterPatches) {
+      // A patch is a w x d rectangle at waterLevel, centred on its translation
+      const float dx = std::max(std::abs(eye.x - patch.m12) - patch.m0 * 0.5f, 0.0f);
+      const float dz = std::max(std::abs(eye.z - patch.m14) - patch.m10 * 0.5f, 0.0f);
+      const float dy = eye.y - patch.m13;
+      nearest = std::min(nearest, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+  }
+  return nearest;
+}
+
+WaterStats GetWaterStats() { return waterStats; }
+
 void UnloadWater() {
-  UnloadModel(waterPlane);
+  UnloadMesh(waterQuad);
+  // The shader belongs to the game; only the material's own maps go
+  MemFree(waterMaterial.maps);
+  waterQuad = {};
+  waterMaterial = {};
   std::cout << "Water unloaded" << std::endl;
 }
@@ -0,0 +1,317 @@
+#include "../core/mappedFile.h"
+#include "game.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Region files hold worldRegionChunks x worldRegionChunks chunks:
+//
+//   RegionHeader
+//   RegionChunkEntry[worldRegionChunks * worldRegionChunks], row-major by z
+//   chunk records, each 4-byte aligned:
+//     float heights[1024], moisture[1024], pathInfluence[1024], normals[3072]
+//     uint8 colors[4096]
+//     uint16 lodIndices[level][lodIndexCounts[level]] for every LOD level
+//
+// Everything is stored in the exact layout ChunkFieldsView points at, so a
+// baked chunk is a set of spans into the mapping. Files are native-endian;
+// bake them on the machine (or at least the architecture) that runs them.
+// Bump regionVersion whenever the layout or generateChunkFields() changes in
+// a way TerrainGeneratorHash() doesn't see.
+
+namespace {
+
+constexpr int chunkSize = 32;
+constexpr int stride = chunkSize - 1;
+constexpr int vertexCount = chunkSize * chunkSize;
+constexpr int regionChunkCount = worldRegionChunks * worldRegionChunks;
+
+constexpr std::array<char, 4> regionMagic = {'R', 'V', 'N', 'R'};
+constexpr std::uint32_t regionVersion = 1;
+
+struct RegionHeader {
+  std::array<char, 4> magic;
+  std::uint32_t version;
+  std::uint64_t generatorHash;
+  std::int32_t rx, rz;
+};
+
+struct RegionChunkEntry {
+  std::uint32_t offset; // From the start of the file; 0 = not baked
+  std::array<std::uint32_t, terrainLodLevels.size()> lodIndexCounts;
+};
+
+constexpr std::size_t chunkFieldBytes =
+    vertexCount * (3 + 3) * sizeof(float) + vertexCount * 4;
+
+struct Region {
+  MappedFile file;
+  std::uint64_t generatorHash;
+  std::span<const RegionChunkEntry> entries;
+};
+
+std::unordered_map<std::pair<int, int>, Region, pair_hash> regions;
+// TerrainGeneratorHash() as of the last open or refresh. Only written with
+// no chunk workers running, so workers can read it without a lock.
+std::uint64_t currentGeneratorHash = 0;
+
+[[nodiscard]] constexpr int floorDiv(int a, int b) noexcept {
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+[[nodiscard]] std::filesystem::path regionPath(const std::filesystem::path &directory,
+                                               int rx, int rz) {
+  return directory / ("region_" + std::to_string(rx) + "_" + std::to_string(rz) + ".bin");
+}
+
+// Chunks the player can reach: anything touching the hard boundary circle
+[[nodiscard]] bool isBakedChunk(int cx, int cz) noexcept {
+  const float minX = static_cast<float>(cx * stride);
+  const float minZ = static_cast<float>(cz * stride);
+  const float dx = std::max({minX - WORLD_CENTER.x, 0.0f,
+                             WORLD_CENTER.x - (minX + stride)});
+  const float dz = std::max({minZ - WORLD_CENTER.z, 0.0f,
+                             WORLD_CENTER.z - (minZ + stride)});
+  return dx * dx + dz * dz <= HARD_BOUNDARY_START * HARD_BOUNDARY_START;
+}
+
+template <typename T> void append(std::vector<std::byte> &out, std::span<const T> data) {
+  const auto *bytes = reinterpret_cast<const std::byte *>(data.data());
+  out.insert(out.end(), bytes, bytes + data.size_bytes());
+}
+
+// Header, entries and every chunk record must lie inside the file
+[[nodiscard]] bool validateRegion(std::span<const std::byte> bytes, int rx, int rz,
+                                  RegionHeader &header,
+                                  std::span<const RegionChunkEntry> &entries) {
+  const std::size_t tableBytes =
+      sizeof(RegionHeader) + regionChunkCount * sizeof(RegionChunkEntry);
+  if (bytes.size() < tableBytes) {
+    return false;
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (header.magic != regionMagic || header.version != regionVersion ||
+      header.rx != rx || header.rz != rz) {
+    return false;
+  }
+
+  entries = {reinterpret_cast<const RegionChunkEntry *>(bytes.data() + sizeof(RegionHeader)),
+             regionChunkCount};
+  for (const RegionChunkEntry &entry : entries) {
+    if (entry.offset == 0) {
+      continue;
+    }
+    std::size_t recordBytes = chunkFieldBytes;
+    for (const std::uint32_t count : entry.lodIndexCounts) {
+      recordBytes += count * sizeof(unsigned short);
+    }
+    if (entry.offset % 4 != 0 || entry.offset < tableBytes ||
+        entry.offset + recordBytes > bytes.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool BakeWorldRegion(const std::filesystem::path &directory, int rx, int rz) {
+  RegionHeader header{regionMagic, regionVersion, TerrainGeneratorHash(), rx, rz};
+  std::array<RegionChunkEntry, regionChunkCount> entries{};
+
+  std::vector<std::byte> records;
+  const std::size_t tableBytes = sizeof(header) + sizeof(entries);
+  for (int lz = 0; lz < worldRegionChunks; ++lz) {
+    for (int lx = 0; lx < worldRegionChunks; ++lx) {
+      const int cx = rx * worldRegionChunks + lx;
+      const int cz = rz * worldRegionChunks + lz;
+      if (!isBakedChunk(cx, cz)) {
+        continue;
+      }
+
+      const ChunkFields fields = generateChunkFields(cx, cz);
+      RegionChunkEntry &entry = entries[lz * worldRegionChunks + lx];
+      entry.offset = static_cast<std::uint32_t>(tableBytes + records.size());
+      append<float>(records, fields.heights);
+      append<float>(records, fields.moisture);
+      append<float>(records, fields.pathInfluence);
+      append<float>(records, fields.normals);
+      append<unsigned char>(records, fields.colors);
+      for (std::size_t i = 0; i < fields.lodIndices.size(); ++i) {
+        entry.lodIndexCounts[i] = static_cast<std::uint32_t>(fields.lodIndices[i].size());
+        append<unsigned short>(records, fields.lodIndices[i]);
+      }
+      records.resize((records.size() + 3) & ~std::size_t{3});
+    }
+  }
+
+  // Written beside the target and renamed, so a region is never half there
+  const std::filesystem::path path = regionPath(directory, rx, rz);
+  std::filesystem::path temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), sizeof(entries));
+    file.write(reinterpret_cast<const char *>(records.data()),
+               static_cast<std::streamsize>(records.size()));
+    if (!file) {
+      std::cout << "ERROR: Failed to write " << temporary << std::endl;
+      return false;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::cout << "ERROR: Failed to write " << path << ": " << error.message()
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool BakeWorld(const std::filesystem::path &directory) {
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    std::cout << "ERROR: Can't create " << directory << ": " << error.message()
+              << std::endl;
+    return false;
+  }
+
+  const int regionMin = floorDiv(WORLD_CHUNK_MIN, worldRegionChunks);
+  const int regionMax = floorDiv(WORLD_CHUNK_MAX, worldRegionChunks);
+  const int regionsPerAxis = regionMax - regionMin + 1;
+  const int regionTotal = regionsPerAxis * regionsPerAxis;
+
+  // Regions are independent; spread them over every core
+  std::atomic<int> nextRegion{0};
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> bakers;
+  const unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned int i = 0; i < count; ++i) {
+    bakers.emplace_back([&] {
+      for (int r = nextRegion++; r < regionTotal; r = nextRegion++) {
+        if (!BakeWorldRegion(directory, regionMin + r % regionsPerAxis,
+                             regionMin + r / regionsPerAxis)) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (auto &baker : bakers) {
+    baker.join();
+  }
+
+  int chunkCount = 0;
+  for (int cz = WORLD_CHUNK_MIN; cz <= WORLD_CHUNK_MAX; ++cz) {
+    for (int cx = WORLD_CHUNK_MIN; cx <= WORLD_CHUNK_MAX; ++cx) {
+      chunkCount += isBakedChunk(cx, cz);
+    }
+  }
+  std::uintmax_t bytes = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+    bytes += entry.is_regular_file() ? entry.file_size() : 0;
+  }
+  const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << "Baked " << chunkCount << " chunks into " << regionTotal
+            << " regions in " << directory << " (" << bytes / (1024 * 1024)
+            << " MB, " << seconds << " s)" << std::endl;
+  return !failed;
+}
+
+void OpenBakedWorld(const std::filesystem::path &directory) {
+  CloseBakedWorld();
+
+  RefreshBakedWorldHash();
+  const std::uint64_t generatorHash = currentGeneratorHash;
+  int current = 0;
+  int stale = 0;
+  const int regionMin = floorDiv(WORLD_CHUNK_MIN, worldRegionChunks);
+  const int regionMax = floorDiv(WORLD_CHUNK_MAX, worldRegionChunks);
+  for (int rz = regionMin; rz <= regionMax; ++rz) {
+    for (int rx = regionMin; rx <= regionMax; ++rx) {
+      MappedFile file(regionPath(directory, rx, rz));
+      if (file.empty()) {
+        continue;
+      }
+
+      RegionHeader header;
+      std::span<const RegionChunkEntry> entries;
+      if (!validateRegion(file.bytes(), rx, rz, header, entries)) {
+        ++stale; // Old format or truncated: never usable
+        continue;
+      }
+
+      // A different generator hash is kept: toggling multi-res noise (M) can
+      // make the region current again. FindBakedChunk() checks every lookup
+      // against the hash RefreshBakedWorldHash() last took.
+      if (header.generatorHash == generatorHash) {
+        ++current;
+      } else {
+        ++stale;
+      }
+      regions.emplace(std::pair{rx, rz},
+                      Region{std::move(file), header.generatorHash, entries});
+    }
+  }
+
+  if (current > 0 || stale > 0) {
+    std::cout << "Baked world: " << current << " regions mapped, " << stale
+              << " stale (built live)" << std::endl;
+  }
+}
+
+void RefreshBakedWorldHash() { currentGeneratorHash = TerrainGeneratorHash(); }
+
+void CloseBakedWorld() { regions.clear(); }
+
+std::optional<ChunkFieldsView> FindBakedChunk(int cx, int cz) {
+  if (regions.empty()) {
+    return std::nullopt;
+  }
+  const int rx = floorDiv(cx, worldRegionChunks);
+  const int rz = floorDiv(cz, worldRegionChunks);
+  const auto it = regions.find({rx, rz});
+  if (it == regions.end() || it->second.generatorHash != currentGeneratorHash) {
+    return std::nullopt;
+  }
+
+  const Region &region = it->second;
+  const RegionChunkEntry &entry =
+      region.entries[static_cast<std::size_t>((cz - rz * worldRegionChunks) * worldRegionChunks +
+                                              (cx - rx * worldRegionChunks))];
+  if (entry.offset == 0) {
+    return std::nullopt;
+  }
+
+  const std::byte *record = region.file.bytes().data() + entry.offset;
+  const auto floats = [&record](std::size_t count) {
+    const std::span<const float> view{reinterpret_cast<const float *>(record), count};
+    record += view.size_bytes();
+    return view;
+  };
+
+  ChunkFieldsView view;
+  view.heights = floats(vertexCount);
+  view.moisture = floats(vertexCount);
+  view.pathInfluence = floats(vertexCount);
+  view.normals = floats(vertexCount * 3);
+  view.colors = {reinterpret_cast<const unsigned char *>(record), vertexCount * 4};
+  record += view.colors.size_bytes();
+  for (std::size_t i = 0; i < view.lodIndices.size(); ++i) {
+    view.lodIndices[i] = {reinterpret_cast<const unsigned short *>(record),
+                          entry.lodIndexCounts[i]};
+    record += view.lodIndices[i].size_bytes();
+  }
+  return view;
+}
@@ -14,9 +14,119 @@ uniform vec3 lightColor;
 uniform vec3 viewPos;
 uniform vec3 worldCenter;
 uniform float worldRadius;
+uniform vec3 fogColor; // The sky dome's horizon
+uniform vec2 fogRange; // Start, and fully opaque at the far plane
+uniform int overdrawView; // Debug: each shaded fragment adds a step of red
+
+#if defined(VEGETATION) || defined(IMPOSTOR_BAKE) || defined(WATER)
+// Model textures; procedural meshes get raylib's 1x1 white
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+#endif
+
+#if defined(VEGETATION) || defined(IMPOSTOR)
+// Geometry and impostors trade pixels in a 4x4 ordered dither while a tree
+// crosses the impostor distance, so neither needs sorting or blending
+in float impostorFadeIn;
+
+float ditherThreshold() {
+    const float bayer[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                    3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+#endif
+
+#ifdef IMPOSTOR
+// Octahedral impostor atlases (see impostors.cpp): views on an N x N
+// hemi-octahedral grid, albedo with coverage in alpha, and normal in rgb
+// with depth (0 nearest) in alpha
+uniform sampler2D texture0;
+uniform sampler2D texture2;
+uniform float impostorViews;
+uniform float impostorRadius;
+uniform mat4 matProjection;
+
+in vec3 impostorPoint;
+in vec3 impostorView;
+in vec3 impostorViewSpace;
+in float impostorScale;
+in mat3 impostorRotation;
+
+vec2 hemiOctEncode(vec3 d) {
+    vec3 p = d / (abs(d.x) + abs(d.y) + abs(d.z));
+    return vec2(p.x + p.z, p.x - p.z);
+}
+
+vec3 hemiOctDecode(vec2 e) {
+    float x = (e.x + e.y) * 0.5;
+    float z = (e.x - e.y) * 0.5;
+    return normalize(vec3(x, 1.0 - abs(x) - abs(z), z));
+}
+
+// Blends the four views around the eye direction, each sampled where the
+// quad point projects onto that view's plane
+void sampleImpostor(out vec4 albedo, out vec4 normalDepth) {
+    vec3 eye = normalize(vec3(impostorView.x, max(impostorView.y, 0.0), impostorView.z));
+    vec2 grid = (hemiOctEncode(eye) * 0.5 + 0.5) * (impostorViews - 1.0);
+    vec2 cell = min(floor(grid), vec2(impostorViews - 2.0));
+    vec2 f = grid - cell;
+
+    albedo = vec4(0.0);
+    normalDepth = vec4(0.0);
+    for (int k = 0; k < 4; ++k) {
+        vec2 corner = vec2(float(k & 1), float(k >> 1));
+        vec2 weights = mix(1.0 - f, f, corner);
+        vec2 view = cell + corner;
+
+        // Same basis as the bake's MatrixLookAt
+        vec3 dir = hemiOctDecode(view / (impostorViews - 1.0) * 2.0 - 1.0);
+        vec3 refUp = abs(dir.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+        vec3 right = normalize(cross(refUp, dir));
+        vec3 up = cross(dir, right);
+        vec2 uv = vec2(dot(impostorPoint, right), dot(impostorPoint, up)) /
+                      (2.0 * impostorRadius) + 0.5;
+        if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) continue;
+
+        vec2 atlasUv = (view + uv) / impostorViews;
+        albedo += weights.x * weights.y * texture(texture0, atlasUv);
+        normalDepth += weights.x * weights.y * texture(texture2, atlasUv);
+    }
+}
+#endif
 
 void main() {
+#ifdef IMPOSTOR_BAKE
+    vec4 bakeTexel = texture(texture0, fragTexCoord) * colDiffuse;
+    if (bakeTexel.a < 0.5) discard;
+#ifdef IMPOSTOR_BAKE_ALBEDO
+    finalColor = vec4(fragColor.rgb * bakeTexel.rgb, 1.0);
+#else
+    finalColor = vec4(normalize(fragNormal) * 0.5 + 0.5, gl_FragCoord.z);
+#endif
+    return;
+#endif
+
+#ifdef IMPOSTOR
+    if (impostorFadeIn <= ditherThreshold()) discard;
+    vec4 impostorAlbedo;
+    vec4 impostorNormalDepth;
+    sampleImpostor(impostorAlbedo, impostorNormalDepth);
+    if (impostorAlbedo.a < 0.5) discard;
+
+    vec3 norm = normalize(impostorRotation * (impostorNormalDepth.xyz * 2.0 - 1.0));
+
+    // Baked depth puts the pixel where the geometry was, so impostors
+    // intersect terrain and each other like the real thing
+    float towardEye = impostorRadius * impostorScale * (1.0 - 2.0 * impostorNormalDepth.a);
+    vec4 clip = matProjection * vec4(impostorViewSpace.xy, impostorViewSpace.z + towardEye, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+#else
+#ifdef VEGETATION
+    if (impostorFadeIn > ditherThreshold()) discard;
+#endif
     vec3 norm = normalize(fragNormal);
+#endif
     vec3 lightDirection = normalize(-lightDir);
     
     vec3 ambient = vec3(0.35, 0.32, 0.30) * lightColor;
@@ -25,30 +135,32 @@ void main() {
     vec3 diffuse = diff * lightColor * 1.0;
     
     vec3 lighting = ambient + diffuse;
+#ifdef VEGETATION
+    vec4 texel = texture(texture0, fragTexCoord) * colDiffuse;
+    if (texel.a < 0.5) discard; // Leaf cards
+    vec3 baseColor = fragColor.rgb * texel.rgb * lighting;
+#elif defined(IMPOSTOR)
+    vec3 baseColor = impostorAlbedo.rgb / impostorAlbedo.a * lighting;
+#elif defined(WATER)
+    vec3 baseColor = colDiffuse.rgb * lighting;
+#else
     vec3 baseColor = fragColor.rgb * lighting;
+#endif
     
     // Calculate distance from world center (XZ plane only)
     float distFromCenter = length(fragPosition.xz - worldCenter.xz);
     
-    // Base fog
-    float fogStart = 15.0;
-    float fogEnd = 80.0;
-    vec3 fogColor = vec3(0.3, 0.3, 0.3);
-    
-    float baseFogFactor = 0.0; // Default disabled
-    
     // Boundary fog - increases beyond world radius
+    vec3 boundaryFogColor = vec3(0.3, 0.3, 0.3);
     float boundaryFogFactor = 0.0;
     if (distFromCenter > worldRadius) {
         float excessDist = distFromCenter - worldRadius;
         // Gradually increase fog density as we go beyond boundary
         boundaryFogFactor = clamp(excessDist / 200.0, 0.0, 0.85);
-        fogColor = mix(fogColor, vec3(0.2, 0.2, 0.25), boundaryFogFactor * 0.5);
+        boundaryFogColor = mix(boundaryFogColor, vec3(0.2, 0.2, 0.25), boundaryFogFactor * 0.5);
     }
     
-    float fogFactor = max(baseFogFactor, boundaryFogFactor);
-    
-    vec3 finalColorRGB = mix(baseColor, fogColor, fogFactor);
+    vec3 finalColorRGB = mix(baseColor, boundaryFogColor, boundaryFogFactor);
     
     // Less desaturation
     float gray = dot(finalColorRGB, vec3(0.299, 0.587, 0.114));
@@ -58,6 +170,18 @@ void main() {
     finalColorRGB.g *= 0.95;  
     finalColorRGB.b *= 1.0;
     
+    // Distance fog, after the grading so it reaches the sky's exact colour
+    // where the far plane cuts the terrain off
+    float distanceFogFactor = smoothstep(fogRange.x, fogRange.y, fragDistance);
+    finalColorRGB = mix(finalColorRGB, fogColor, distanceFogFactor);
+    
+#ifdef WATER
+    finalColor = vec4(finalColorRGB, colDiffuse.a); // Blended over the terrain
+#else
     finalColor = vec4(finalColorRGB, 1.0);
+#endif
+    if (overdrawView != 0) {
+        finalColor = vec4(1.0 / 32.0, 0.25 / 32.0, 0.0, 1.0); // Added up
+    }
 }
 
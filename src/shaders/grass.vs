@@ -0,0 +1,123 @@
+// src/shaders/grass.vs
+#version 330
+
+// GPU grass (see grass.cpp): one instanced draw per chunk of a single blade
+// mesh. Everything per blade comes from gl_InstanceID, hash noise and the
+// chunk's grass field, so the CPU only picks a blade count.
+in vec3 vertexPosition; // x across the blade in [-0.5, 0.5], y up it in [0, 1]
+
+out vec3 fragPosition;
+out vec3 fragNormal;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out float fragDistance;
+
+uniform mat4 mvp; // View-projection; blades are built in world space
+uniform vec3 viewPos;
+
+// Per vertex of the chunk's 32x32 grid: world height, path influence,
+// moisture
+uniform sampler2D grassField;
+uniform ivec2 chunkCoord;
+uniform int grassCells;    // Full-density blades per chunk side
+uniform int grassStep;     // Cells per drawn blade along each side at this LOD
+uniform float grassTime;   // Seconds, for the wind
+uniform float waterLevel;
+uniform vec2 grassFade;    // Blades shrink away over this distance range
+
+const float stride = 31.0;
+
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state) {
+    state = hash(state);
+    return float(state >> 8) / 16777216.0;
+}
+
+vec3 fieldAt(int x, int z) {
+    return texelFetch(grassField, ivec2(clamp(x, 0, 31), clamp(z, 0, 31)), 0).xyz;
+}
+
+// Height as the terrain mesh has it: two triangles per cell split along
+// the top-right to bottom-left diagonal. Path and moisture are bilinear.
+vec3 sampleField(vec2 local) {
+    ivec2 cell = ivec2(min(floor(local), vec2(stride - 1.0)));
+    vec2 f = local - vec2(cell);
+    vec3 v00 = fieldAt(cell.x, cell.y);
+    vec3 v10 = fieldAt(cell.x + 1, cell.y);
+    vec3 v01 = fieldAt(cell.x, cell.y + 1);
+    vec3 v11 = fieldAt(cell.x + 1, cell.y + 1);
+
+    float height = f.x + f.y <= 1.0
+        ? v00.x + f.x * (v10.x - v00.x) + f.y * (v01.x - v00.x)
+        : v11.x + (1.0 - f.x) * (v01.x - v11.x) + (1.0 - f.y) * (v10.x - v11.x);
+    vec2 rest = mix(mix(v00.yz, v10.yz, f.x), mix(v01.yz, v11.yz, f.x), f.y);
+    return vec3(height, rest);
+}
+
+void main() {
+    // Blades at a coarser LOD are a subset of the full-density ones, and
+    // hash the same, so they don't move when the LOD changes
+    int perSide = grassCells / grassStep;
+    ivec2 cell = ivec2(gl_InstanceID % perSide, gl_InstanceID / perSide) * grassStep;
+    ivec2 worldCell = chunkCoord * grassCells + cell;
+    uint state = hash(uint(worldCell.x) * 73856093u ^ uint(worldCell.y) * 19349663u);
+
+    float cellSize = stride / float(grassCells);
+    vec2 local = (vec2(cell) + vec2(random(state), random(state))) * cellSize;
+    vec3 field = sampleField(local);
+    vec2 origin = vec2(chunkCoord) * stride;
+    vec3 root = vec3(origin.x + local.x, field.x, origin.y + local.y);
+
+    float eyeDistance = length(viewPos - root);
+    float height = mix(0.35, 0.9, random(state)) * (0.7 + 0.6 * field.z);
+    height *= 1.0 - smoothstep(grassFade.x, grassFade.y, eyeDistance);
+    // Trodden flat on paths, drowned under water
+    height *= 1.0 - smoothstep(0.0, 0.15, field.y);
+    if (root.y < waterLevel) height = 0.0;
+    if (height <= 0.0) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0); // Outside the clip volume
+        return;
+    }
+
+    float angle = random(state) * 6.2831853;
+    vec3 across = vec3(cos(angle), 0.0, sin(angle));
+    vec3 facing = vec3(-across.z, 0.0, across.x);
+    // Thinned LODs get wider blades to cover the same ground
+    float width = 0.06 * sqrt(float(grassStep)) * (0.8 + 0.4 * random(state));
+
+    // Wind: a slow gust front across the field plus per-blade flutter,
+    // bending the tip more than the root
+    float along = vertexPosition.y;
+    vec2 wind = normalize(vec2(1.0, 0.4));
+    float gust = sin(grassTime * 1.3 + dot(root.xz, wind) * 0.15) * 0.5 + 0.5;
+    float flutter = sin(grassTime * 4.0 + random(state) * 6.2831853) * 0.1;
+    vec2 lean = wind * (gust * 0.35 + flutter) +
+                (vec2(random(state), random(state)) - 0.5) * 0.3;
+    vec3 bend = vec3(lean.x, 0.0, lean.y) * along * along * height;
+
+    vec3 world = root + across * vertexPosition.x * width * (1.0 - along * 0.8) +
+                 vec3(0.0, along * height, 0.0) + bend;
+
+    // Mostly up, so blades light like the ground under them; turned
+    // towards the eye since both sides are seen
+    vec3 side = dot(facing, viewPos - root) < 0.0 ? -facing : facing;
+    fragNormal = normalize(vec3(0.0, 1.0, 0.0) + side * 0.4);
+
+    vec3 dry = vec3(0.62, 0.54, 0.34);
+    vec3 green = vec3(0.38, 0.45, 0.24);
+    vec3 tip = mix(dry, green, clamp(field.z * 1.2 - 0.2, 0.0, 1.0));
+    fragColor = vec4(tip * mix(0.45, 1.0, along), 1.0);
+
+    fragPosition = world;
+    fragTexCoord = vec2(vertexPosition.x + 0.5, along);
+    fragDistance = length(viewPos - world);
+    gl_Position = mvp * vec4(world, 1.0);
+}
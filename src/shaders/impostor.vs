@@ -0,0 +1,57 @@
+// src/shaders/impostor.vs
+#version 330
+
+// Octahedral impostors (see impostors.cpp): a camera-facing quad per
+// instance, shaded by fragment.glsl's IMPOSTOR path from the baked views
+in vec3 vertexPosition; // Quad corner, xy in [-1, 1]
+in mat4 instanceTransform;
+
+out vec3 fragPosition;
+out vec3 fragNormal;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out float fragDistance;
+
+out vec3 impostorPoint;    // On the quad, model frame at scale 1, from the centre
+out vec3 impostorView;     // Towards the eye, model frame
+out vec3 impostorViewSpace; // The quad point in view space
+out float impostorScale;
+out float impostorFadeIn;
+out mat3 impostorRotation;
+
+uniform mat4 matView;
+uniform mat4 matProjection;
+uniform vec3 viewPos;
+
+uniform float impostorRadius;  // Bounding sphere at scale 1
+uniform float impostorCentreY; // Its centre above the model origin
+uniform vec2 impostorFade;     // Geometry gives way to the impostor over this range
+
+void main() {
+    float scale = length(instanceTransform[0].xyz);
+    mat3 rotation = mat3(instanceTransform) / scale;
+    vec3 centre = (instanceTransform * vec4(0.0, impostorCentreY, 0.0, 1.0)).xyz;
+
+    // Camera-facing: view space right and up, as world vectors
+    vec3 right = vec3(matView[0][0], matView[1][0], matView[2][0]);
+    vec3 up = vec3(matView[0][1], matView[1][1], matView[2][1]);
+    vec3 world = centre + (right * vertexPosition.x + up * vertexPosition.y) *
+                              impostorRadius * scale;
+
+    impostorPoint = transpose(rotation) * (world - centre) / scale;
+    impostorView = transpose(rotation) * normalize(viewPos - centre);
+    impostorViewSpace = (matView * vec4(world, 1.0)).xyz;
+    impostorScale = scale;
+    impostorRotation = rotation;
+
+    float distance = length(viewPos - instanceTransform[3].xyz);
+    impostorFadeIn = clamp((distance - impostorFade.x) / (impostorFade.y - impostorFade.x), 0.0, 1.0);
+
+    fragPosition = world;
+    fragNormal = vec3(0.0, 1.0, 0.0);
+    fragTexCoord = vertexPosition.xy * 0.5 + 0.5;
+    fragColor = vec4(1.0);
+    fragDistance = length(viewPos - world);
+
+    gl_Position = matProjection * vec4(impostorViewSpace, 1.0);
+}
@@ -1,13 +1,16 @@
 #version 330
 
-in vec3 fragTexCoord;
+in vec3 fragDirection;
 
-uniform samplerCube skybox;
+uniform vec3 skyTop;
+uniform vec3 skyHorizon;
 
 out vec4 finalColor;
 
 void main()
 {
-    finalColor = texture(skybox, fragTexCoord);
-}
+    // Zenith to horizon by elevation angle, as the dome's rings are spaced
+    float t = acos(clamp(normalize(fragDirection).y, 0.0, 1.0)) / 1.5707963;
 
+    finalColor = vec4(mix(skyTop, skyHorizon, t), 1.0);
+}
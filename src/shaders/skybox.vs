@@ -2,18 +2,20 @@
 
 in vec3 vertexPosition;
 
-uniform mat4 projection;
-uniform mat4 view;
+uniform mat4 matView;
+uniform mat4 matProjection;
 
-out vec3 fragTexCoord;
+out vec3 fragDirection;
 
 void main()
 {
-    fragTexCoord = vertexPosition;
-    
-    mat4 rotView = mat4(mat3(view));
-    vec4 pos = projection * rotView * vec4(vertexPosition, 1.0);
-    
-    gl_Position = pos.xyww;
-}
+    fragDirection = vertexPosition;
+
+    // Rotation only, so the dome stays centred on the eye
+    mat4 rotView = mat4(mat3(matView));
+    vec4 pos = matProjection * rotView * vec4(vertexPosition, 1.0);
 
+    // Just inside the far plane, so the default depth test lets it through
+    // only where nothing has been drawn
+    gl_Position = vec4(pos.xy, pos.w * 0.99999, pos.w);
+}
@@ -0,0 +1,15 @@
+#version 330
+
+in vec2 fragCorner;
+in float fragAlpha;
+
+out vec4 finalColor;
+
+void main()
+{
+    // Round, and the faintest left out
+    if (fragAlpha <= 0.1 || dot(fragCorner, fragCorner) > 1.0) discard;
+
+    vec3 starColor = vec3(1.0, 0.94, 0.86);
+    finalColor = vec4(starColor * fragAlpha, fragAlpha);
+}
@@ -0,0 +1,28 @@
+#version 330
+
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;  // Quad corner, -1 to 1
+in vec2 vertexTexCoord2; // Brightness, size
+
+uniform mat4 matView;
+uniform mat4 matProjection;
+
+out vec2 fragCorner;
+out float fragAlpha;
+
+void main()
+{
+    // Fade into the haze along with the dome's gradient
+    float haze = acos(clamp(normalize(vertexPosition).y, 0.0, 1.0)) / 1.5707963;
+    fragAlpha = vertexTexCoord2.x * (1.0 - haze);
+    fragCorner = vertexTexCoord;
+
+    // Centred on the eye like the dome, then spread into a camera-facing quad
+    vec4 viewPos = mat4(mat3(matView)) * vec4(vertexPosition, 1.0);
+    viewPos.xy += vertexTexCoord * vertexTexCoord2.y;
+    vec4 pos = matProjection * viewPos;
+
+    // Just inside the far plane, so the default depth test lets it through
+    // only where nothing has been drawn
+    gl_Position = vec4(pos.xy, pos.w * 0.99999, pos.w);
+}
@@ -1,9 +1,17 @@
 // src/shaders/vertex.glsl
 #version 330
 
+#ifdef PACKED_TERRAIN
+// PackedTerrainVertex (see terrainMesh.cpp): unorm16 height that matModel
+// scales to world units, grid x/z, and an octahedral normal around +Y
+in float vertexPosition;
+in vec2 vertexTexCoord;
+in vec2 vertexNormal;
+#else
 in vec3 vertexPosition;
 in vec3 vertexNormal;
 in vec2 vertexTexCoord;
+#endif
 in vec4 vertexColor;
 
 out vec3 fragPosition;
@@ -16,15 +24,82 @@ uniform mat4 mvp;
 uniform mat4 matModel;
 uniform vec3 viewPos;
 
+#ifdef VEGETATION
+// DrawMeshInstanced: per-instance model matrix, with mvp just view-projection
+in mat4 instanceTransform;
+uniform mat4 vegetationFit; // Model to the type's frame, before the instance's
+uniform vec2 impostorFade;  // Geometry gives way to the impostor over this range
+out float impostorFadeIn;
+#endif
+
+#ifdef WATER
+// DrawMeshInstanced: unit quads stretched over a chunk's submerged cells
+in mat4 instanceTransform;
+#endif
+
+#ifdef TERRAIN_ARENA
+// Terrain arena (see terrainMesh.cpp): chunk-local vertices in 64-vertex
+// pages, with each page's chunk origin in xy of a 256-wide page table
+uniform sampler2D chunkOrigins;
+#endif
+
+#ifdef PACKED_TERRAIN
+vec3 decodeOctahedral(vec2 encoded) {
+    vec2 e = encoded * 2.0 - 1.0;
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0) {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * signs;
+    }
+    return normalize(n);
+}
+#endif
+
 void main() {
-    vec4 worldPos = matModel * vec4(vertexPosition, 1.0);
-    fragPosition = worldPos.xyz;
-    fragNormal = normalize(mat3(matModel) * vertexNormal);
+#ifdef PACKED_TERRAIN
+    vec3 position = vec3(vertexTexCoord.x, vertexPosition, vertexTexCoord.y);
+    // Chunks are only translated and scaled in Y, so the normal is already
+    // in world space (matModel's Y scale would distort it)
+    vec3 normal = decodeOctahedral(vertexNormal);
+    fragTexCoord = vertexTexCoord / 31.0;
+#else
+    vec3 position = vertexPosition;
+    vec3 normal = mat3(matModel) * vertexNormal;
+#ifdef TERRAIN_ARENA
+    fragTexCoord = vertexPosition.xz / 31.0;
+#else
     fragTexCoord = vertexTexCoord;
+#endif
+#endif
+
+#ifdef TERRAIN_ARENA
+    // gl_VertexID includes the draw's base vertex, so it's the arena index
+    int page = gl_VertexID / 64;
+    position.xz += texelFetch(chunkOrigins, ivec2(page % 256, page / 256), 0).xy;
+#endif
+
+#ifdef VEGETATION
+    mat4 model = instanceTransform * vegetationFit;
+    normal = mat3(model) * vertexNormal;
+    vec4 worldPos = model * vec4(position, 1.0);
+    float distance = length(viewPos - instanceTransform[3].xyz);
+    impostorFadeIn = clamp((distance - impostorFade.x) / (impostorFade.y - impostorFade.x), 0.0, 1.0);
+#elif defined(WATER)
+    normal = vec3(0.0, 1.0, 0.0);
+    vec4 worldPos = instanceTransform * vec4(position, 1.0);
+#else
+    vec4 worldPos = matModel * vec4(position, 1.0);
+#endif
+    fragPosition = worldPos.xyz;
+    fragNormal = normalize(normal);
     fragColor = vertexColor;
     
     fragDistance = length(viewPos - fragPosition);
     
-    gl_Position = mvp * vec4(vertexPosition, 1.0);
+#if defined(VEGETATION) || defined(WATER)
+    gl_Position = mvp * worldPos;
+#else
+    gl_Position = mvp * vec4(position, 1.0);
+#endif
 }
 